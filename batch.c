@@ -0,0 +1,158 @@
+#include "batch.h"
+#include "sudoku.h"
+
+/**
+ * A kernel that runs the singles propagation of many sudokus in lockstep.
+ * Every cell of the batch is a vector that holds the pencilmarks of that cell
+ * for every sudoku, so the same instructions eliminate, find naked singles
+ * and find hidden singles for all the sudokus at once.
+ *
+ * The kernel never guesses. A sudoku that can't be solved with singles alone
+ * is reported as undecided so that the caller can hand it over to a scalar
+ * engine, all the others are solved (or found to have no solution) here.
+ */
+
+/**
+ * This function loads the sudokus of the batch. Every char that is not a
+ * digit from 1 to 9 is an empty cell which can hold every value for now
+ */
+void batch_load_from_char(SudokuBatch *b, char **sudokus, int num_sudokus)
+{
+    b->num_sudokus = num_sudokus;
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        for (int lane = 0; lane < BATCH_LANES; lane++)
+        {
+            char c = (lane < num_sudokus) ? sudokus[lane][i] : '0';
+            b->cells[i][lane] = (c >= '1' && c <= '9') ? (1 << (c - '0')) : ALL_PENCILMARKS;
+        }
+    }
+}
+
+/**
+ * This function returns true when any lane of a vector is not zero
+ */
+static inline int lanes_any(BatchLanes *v)
+{
+    for (int lane = 0; lane < BATCH_LANES; lane++)
+    {
+        if ((*v)[lane])
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * This function removes the values of the filled in cells from the pencilmarks
+ * of their neighbors, for every sudoku at once. The lanes that changed are
+ * added to changed
+ */
+static inline void batch_eliminate(SudokuBatch *b, BatchLanes *changed)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        BatchLanes x = b->cells[i];
+        //every lane where the cell has a single pencilmark is all ones
+        BatchLanes single = (BatchLanes)((x & (x - 1)) == 0);
+        BatchLanes solved = x & single;
+
+        for (int n = 0; n < SUDOKU_NEIGHBORS; n++)
+        {
+            BatchLanes old = b->cells[NEIGHBORS[i][n]];
+            BatchLanes now = old & ~solved;
+            *changed |= old ^ now;
+            b->cells[NEIGHBORS[i][n]] = now;
+        }
+    }
+}
+
+/**
+ * This function fills in the values that fit in only one cell of a house, for
+ * every sudoku at once. The lanes that changed are added to changed, the lanes
+ * where a value fits nowhere in a house are added to the dead lanes
+ */
+static inline void batch_hidden_singles(SudokuBatch *b, BatchLanes *changed, BatchLanes *dead)
+{
+    const BatchLanes all = (BatchLanes){0} + ALL_PENCILMARKS;
+
+    for (int h = 0; h < 27; h++)
+    {
+        //the values that appear at least once and at least twice in the house
+        BatchLanes once = {0};
+        BatchLanes twice = {0};
+        for (int k = 0; k < 9; k++)
+        {
+            BatchLanes x = b->cells[HOUSES[h][k]];
+            twice |= once & x;
+            once |= x;
+        }
+
+        *dead |= (BatchLanes)(once != all);
+        BatchLanes unique = once & ~twice;
+
+        for (int k = 0; k < 9; k++)
+        {
+            BatchLanes old = b->cells[HOUSES[h][k]];
+            BatchLanes u = old & unique;
+            //in the lanes where the cell holds a unique value keep only that value
+            BatchLanes has = (BatchLanes)(u != 0);
+            BatchLanes now = (old & ~has) | (u & has);
+            *changed |= old ^ now;
+            b->cells[HOUSES[h][k]] = now;
+        }
+    }
+}
+
+/**
+ * This function propagates naked and hidden singles in every sudoku of the
+ * batch until none of them changes any more. Then it writes the result of every
+ * sudoku in results, SUDOKU_UNDECIDED means that the sudoku needs guessing
+ */
+void batch_propagate(SudokuBatch *b, int *results)
+{
+    BatchLanes dead = {0};
+
+    //so long as at least one sudoku made progress
+    while (1)
+    {
+        BatchLanes changed = {0};
+        batch_eliminate(b, &changed);
+        batch_hidden_singles(b, &changed, &dead);
+        if (!lanes_any(&changed))
+            break;
+    }
+
+    //a sudoku is solved when every cell has exactly one pencilmark,
+    //and has no solution when a cell has none
+    BatchLanes not_single = {0};
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        BatchLanes x = b->cells[i];
+        dead |= (BatchLanes)(x == 0);
+        not_single |= (BatchLanes)((x & (x - 1)) != 0);
+    }
+
+    for (int lane = 0; lane < b->num_sudokus; lane++)
+    {
+        if (dead[lane])
+            results[lane] = SUDOKU_NO_SOLUTUION;
+        else if (not_single[lane])
+            results[lane] = SUDOKU_UNDECIDED;
+        else
+            results[lane] = SUDOKU_SOLVED;
+    }
+}
+
+/**
+ * This function writes the values of the sudoku in a lane, a cell that
+ * still has more than one pencilmark is written as empty
+ */
+void batch_get_values(SudokuBatch *b, int lane, uint8_t *values)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        int x = b->cells[i][lane];
+        values[i] = (x && is_power_of_two(x)) ? trailing_zeros(x) : 0;
+    }
+}
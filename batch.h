@@ -0,0 +1,31 @@
+#if !defined(BATCH_H)
+#define BATCH_H
+
+#include <stdint.h>
+#include "tables.h"
+
+//how many sudokus are solved side by side, one in every lane of a vector
+#define BATCH_LANES 16
+
+/**
+ * One pencilmark set for every lane. The vector type lets the compiler use
+ * SSE/AVX registers, so an operation on it works on all the sudokus at once
+ */
+typedef uint16_t BatchLanes __attribute__((vector_size(BATCH_LANES * sizeof(uint16_t))));
+
+/**
+ * Up to BATCH_LANES sudokus in structure of arrays form. Every cell holds the
+ * pencilmarks of that cell for every sudoku of the batch, a filled in cell
+ * has exactly one pencilmark. Lanes after num_sudokus are empty sudokus
+ */
+typedef struct _SudokuBatch
+{
+    BatchLanes cells[SUDOKU_CELLS];
+    int num_sudokus;
+} __attribute__((aligned(64))) SudokuBatch;
+
+void batch_load_from_char(SudokuBatch *b, char **sudokus, int num_sudokus);
+void batch_propagate(SudokuBatch *b, int *results);
+void batch_get_values(SudokuBatch *b, int lane, uint8_t *values);
+
+#endif // BATCH_H
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <limits.h>
+#include "sudoku.h"
+#include "file.h"
+#include "utils.h"
+#include "engine.h"
+
+/**
+ * The benchmark of the solver. It solves every corpus with every engine it is
+ * given, once or more to warm up and then a number of timed runs, and prints
+ * one tab separated line for every corpus and engine:
+ *
+ * corpus engine puzzles solved puzzles_per_sec p50_us p90_us p99_us max_us steps_per_puzzle
+ *
+ * The puzzles per second are the median of the timed runs, the latencies are
+ * taken over the puzzles of all the timed runs. Everything runs on one thread
+ * so that the numbers of two builds can be compared directly.
+ *
+ * usage: bench [-e engine,engine,...] [-r runs] [-w warmups] [-n max sudokus] [corpus files...]
+ */
+
+//the corpora that are swept when none are given
+#define BENCH_DATA_DIR "data"
+#define BENCH_MAX_CORPORA 64
+
+//the backtracking engine is left out by default, it needs
+//minutes for the hard corpora
+char *engine_names = "pencilmarks,bitboard,simd,dlx";
+int num_runs = 3;
+int num_warmups = 1;
+int max_sudokus = INT_MAX;
+
+/**
+ * The measurements of one run over a corpus
+ */
+typedef struct _BenchRun
+{
+    //in nanoseconds
+    int64_t elapsed;
+    int solved;
+    long long steps;
+} BenchRun;
+
+/**
+ * This function compares two doubles for qsort
+ */
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * This function compares two strings for qsort
+ */
+static int compare_string(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * This function returns the value at a percentile of a sorted array
+ */
+static int64_t percentile(int64_t *sorted, int n, double p)
+{
+    int i = (int)(p * (n - 1) + 0.5);
+    return sorted[i];
+}
+
+/**
+ * This function solves every sudoku of a corpus once and writes the latency
+ * of every sudoku in latencies, in nanoseconds, if they are given
+ */
+static BenchRun bench_run(const SolverEngine *engine, void *state, SudokuFile *f, int64_t *latencies)
+{
+    BenchRun run = {0, 0, 0};
+    int result;
+    EngineCounters counters;
+
+    int64_t runStart = getTimeNs();
+
+    if (engine->solve_batch != NULL)
+    {
+        int lanes = engine->batch_lanes;
+        int results[lanes];
+        uint8_t values[lanes][SUDOKU_CELLS];
+
+        for (int first = 0; first < f->num_sudokus; first += lanes)
+        {
+            int count = min(f->num_sudokus - first, lanes);
+
+            int64_t start = getTimeNs();
+            engine->solve_batch(&f->sudokus[first], count, results, values);
+            int64_t shared = (getTimeNs() - start) / count;
+
+            for (int lane = 0; lane < count; lane++)
+            {
+                int64_t latency = shared;
+                result = results[lane];
+
+                //the sudokus the kernel couldn't decide are solved one by one
+                if (result == SUDOKU_UNDECIDED)
+                {
+                    start = getTimeNs();
+                    engine->load_from_char(state, f->sudokus[first + lane]);
+                    engine->solve(state, &result);
+                    if (engine->release != NULL)
+                        engine->release(state);
+                    latency += getTimeNs() - start;
+                    engine->get_counters(state, &counters);
+                    run.steps += counters.steps;
+                }
+
+                run.solved += result == SUDOKU_SOLVED;
+                if (latencies != NULL)
+                    latencies[first + lane] = latency;
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < f->num_sudokus; i++)
+        {
+            int64_t start = getTimeNs();
+            engine->load_from_char(state, f->sudokus[i]);
+            engine->solve(state, &result);
+            if (engine->release != NULL)
+                engine->release(state);
+            int64_t latency = getTimeNs() - start;
+
+            engine->get_counters(state, &counters);
+            run.steps += counters.steps;
+            run.solved += result == SUDOKU_SOLVED;
+            if (latencies != NULL)
+                latencies[i] = latency;
+        }
+    }
+
+    run.elapsed = getTimeNs() - runStart;
+    return run;
+}
+
+/**
+ * This function benchmarks an engine on a corpus and prints its line of the table
+ */
+static void bench_corpus(const SolverEngine *engine, char *filename)
+{
+    SudokuFile *f = sudoku_file_open(filename, max_sudokus);
+    if (f == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", filename);
+        return;
+    }
+    if (f->num_sudokus == 0)
+    {
+        sudoku_file_close(f);
+        return;
+    }
+
+    EngineOptions options = {0};
+    void *state = engine->create(&options);
+
+    for (int i = 0; i < num_warmups; i++)
+    {
+        bench_run(engine, state, f, NULL);
+    }
+
+    int n = f->num_sudokus;
+    int64_t *latencies = (int64_t *)malloc((size_t)num_runs * n * sizeof(int64_t));
+    double *rates = (double *)malloc(num_runs * sizeof(double));
+    BenchRun run = {0, 0, 0};
+
+    for (int r = 0; r < num_runs; r++)
+    {
+        run = bench_run(engine, state, f, &latencies[(size_t)r * n]);
+        rates[r] = n / (run.elapsed / 1e9);
+    }
+
+    qsort(latencies, (size_t)num_runs * n, sizeof(int64_t), compare_int64);
+    qsort(rates, num_runs, sizeof(double), compare_double);
+
+    //the corpus is named after its file, without the directory
+    char *corpus = strrchr(filename, '/');
+    corpus = (corpus) ? corpus + 1 : filename;
+
+    int total = num_runs * n;
+    printf("%s\t%s\t%d\t%d\t%.0f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n", corpus, engine->name, n, run.solved,
+           rates[num_runs / 2], percentile(latencies, total, 0.50) / 1e3, percentile(latencies, total, 0.90) / 1e3,
+           percentile(latencies, total, 0.99) / 1e3, latencies[total - 1] / 1e3, (double)run.steps / n);
+    fflush(stdout);
+
+    free(latencies);
+    free(rates);
+    engine->free(state);
+    sudoku_file_close(f);
+}
+
+/**
+ * This function finds the corpora of the data directory, sorted by name
+ */
+static int find_corpora(char **corpora)
+{
+    DIR *dir = opendir(BENCH_DATA_DIR);
+    if (dir == NULL)
+        return 0;
+
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && count < BENCH_MAX_CORPORA)
+    {
+        size_t len = strlen(entry->d_name);
+        if (len > 4 && strcmp(entry->d_name + len - 4, ".txt") == 0)
+        {
+            corpora[count] = (char *)malloc(strlen(BENCH_DATA_DIR) + len + 2);
+            sprintf(corpora[count], "%s/%s", BENCH_DATA_DIR, entry->d_name);
+            count++;
+        }
+    }
+    closedir(dir);
+
+    qsort(corpora, count, sizeof(char *), compare_string);
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    char *corpora[BENCH_MAX_CORPORA];
+    int num_corpora = 0;
+    int own_corpora = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        char *arg = argv[i];
+        //the min and max macros evaluate their arguments twice,
+        //so the values are read before they are clamped
+        if (strequals(arg, "-e") && i + 1 < argc)
+            engine_names = argv[++i];
+        else if (strequals(arg, "-r") && i + 1 < argc)
+        {
+            num_runs = atoi(argv[++i]);
+            num_runs = max(num_runs, 1);
+        }
+        else if (strequals(arg, "-w") && i + 1 < argc)
+        {
+            num_warmups = atoi(argv[++i]);
+            num_warmups = max(num_warmups, 0);
+        }
+        else if (strequals(arg, "-n") && i + 1 < argc)
+        {
+            max_sudokus = atoi(argv[++i]);
+            max_sudokus = max(max_sudokus, 1);
+        }
+        else if (num_corpora < BENCH_MAX_CORPORA)
+            corpora[num_corpora++] = arg;
+    }
+
+    //without corpora sweep everything in the data directory
+    if (num_corpora == 0)
+    {
+        num_corpora = find_corpora(corpora);
+        own_corpora = 1;
+    }
+
+    engine_register_defaults();
+
+    //find the engines before anything runs, so a typo doesn't waste a sweep
+    const SolverEngine *engines[ENGINE_CAPACITY];
+    int num_engines = 0;
+    char names[256];
+    snprintf(names, sizeof(names), "%s", engine_names);
+    for (char *name = strtok(names, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        const SolverEngine *engine = engine_find(name);
+        if (engine == NULL)
+        {
+            fprintf(stderr, "Unknown engine %s\n", name);
+            return 1;
+        }
+        if (num_engines < ENGINE_CAPACITY)
+            engines[num_engines++] = engine;
+    }
+
+    printf("corpus\tengine\tpuzzles\tsolved\tpuzzles_per_sec\tp50_us\tp90_us\tp99_us\tmax_us\tsteps_per_puzzle\n");
+    for (int c = 0; c < num_corpora; c++)
+    {
+        for (int e = 0; e < num_engines; e++)
+        {
+            bench_corpus(engines[e], corpora[c]);
+        }
+    }
+
+    if (own_corpora)
+    {
+        for (int c = 0; c < num_corpora; c++)
+        {
+            free(corpora[c]);
+        }
+    }
+
+    return 0;
+}
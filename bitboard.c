@@ -0,0 +1,403 @@
+#include "bitboard.h"
+#include "sudoku.h"
+
+/**
+ * A second solving engine that keeps, for every digit, the set of cells
+ * where it can go as a CellMask (three 27-bit bands). Eliminations, naked
+ * singles and hidden singles are computed with bitwise operations on whole
+ * bands instead of looping over cells and their pencilmarks:
+ *
+ *  - placing a digit removes the cell from every digit's board and removes
+ *    the peers of the cell from the digit's board
+ *  - a cell is a naked single when it is in exactly one digit's board, which
+ *    is found for all cells at once by accumulating "in at least one" and
+ *    "in at least two" boards
+ *  - a digit is a hidden single in a house when its board intersected with
+ *    the house has exactly one cell
+ *
+ * When nothing more can be deduced the engine guesses on the empty cell with
+ * the fewest candidates, trying the digits in ascending order on a copy of
+ * the state.
+ */
+
+#define BITBOARD_CONTRADICTION -1
+#define BITBOARD_STUCK 0
+#define BITBOARD_SOLVED 1
+
+/**
+ * This function returns true when a set of cells is empty
+ */
+static inline int mask_is_empty(CellMask m)
+{
+    return (m.band[0] | m.band[1] | m.band[2]) == 0;
+}
+
+/**
+ * This function returns true when a set holds exactly one cell. It only needs
+ * to tell one cell from more, so it doesn't count the cells of every band
+ */
+static inline int mask_is_single(CellMask m)
+{
+    //exactly one band has cells
+    if ((m.band[0] != 0) + (m.band[1] != 0) + (m.band[2] != 0) != 1)
+        return 0;
+    //and it has a single one
+    uint32_t band = m.band[0] | m.band[1] | m.band[2];
+    return (band & (band - 1)) == 0;
+}
+
+/**
+ * This function returns the cells that are in both sets
+ */
+static inline CellMask mask_and(CellMask a, CellMask b)
+{
+    CellMask m = {{a.band[0] & b.band[0], a.band[1] & b.band[1], a.band[2] & b.band[2]}};
+    return m;
+}
+
+/**
+ * This function fills in a digit in a cell. The caller must make sure that
+ * the digit is a candidate of the cell
+ */
+static inline void bitboard_place(Bitboard *b, BitboardState *s, int digit, int index)
+{
+    //the cell is no longer a candidate for any digit
+    for (int d = 0; d < BITBOARD_DIGITS; d++)
+    {
+        CELL_MASK_REMOVE(s->candidates[d], index);
+    }
+
+    //the digit can no longer go in any peer of the cell
+    const CellMask *peers = &PEER_MASKS[index];
+    s->candidates[digit].band[0] &= ~peers->band[0];
+    s->candidates[digit].band[1] &= ~peers->band[1];
+    s->candidates[digit].band[2] &= ~peers->band[2];
+
+    //but it stays in the board of its digit as a placed cell
+    CELL_MASK_ADD(s->candidates[digit], index);
+    CELL_MASK_REMOVE(s->empty, index);
+
+    b->values[index] = (uint8_t)(digit + 1);
+}
+
+/**
+ * This function counts in how many digit boards every empty cell is.
+ * ones holds the cells with at least one candidate, twos those with at least
+ * two and threes those with at least three
+ */
+static inline void bitboard_count_candidates(BitboardState *s, CellMask *ones, CellMask *twos, CellMask *threes)
+{
+    for (int band = 0; band < 3; band++)
+    {
+        uint32_t one = 0, two = 0, three = 0;
+        for (int d = 0; d < BITBOARD_DIGITS; d++)
+        {
+            uint32_t c = s->candidates[d].band[band] & s->empty.band[band];
+            three |= two & c;
+            two |= one & c;
+            one |= c;
+        }
+        ones->band[band] = one;
+        twos->band[band] = two;
+        threes->band[band] = three;
+    }
+}
+
+/**
+ * This function fills in naked and hidden singles until there are none
+ * left. It returns whether the sudoku got solved, got stuck or cannot
+ * be solved any more
+ */
+static int bitboard_propagate(Bitboard *b, BitboardState *s)
+{
+    while (!mask_is_empty(s->empty))
+    {
+        CellMask ones, twos, threes;
+        bitboard_count_candidates(s, &ones, &twos, &threes);
+
+        //an empty cell without candidates means that a wrong value was placed
+        for (int band = 0; band < 3; band++)
+        {
+            if (s->empty.band[band] & ~ones.band[band])
+                return BITBOARD_CONTRADICTION;
+        }
+
+        //the empty cells that have exactly one candidate
+        CellMask singles = {{ones.band[0] & ~twos.band[0], ones.band[1] & ~twos.band[1],
+                             ones.band[2] & ~twos.band[2]}};
+
+        if (!mask_is_empty(singles))
+        {
+            int index;
+            while ((index = cell_mask_pop(&singles)) >= 0)
+            {
+                //find the digit of the single, a single we placed before
+                //in this round might have taken it away
+                int digit = 0;
+                while (digit < BITBOARD_DIGITS && !CELL_MASK_HAS(s->candidates[digit], index))
+                    digit++;
+                if (digit == BITBOARD_DIGITS)
+                    return BITBOARD_CONTRADICTION;
+                bitboard_place(b, s, digit, index);
+            }
+            continue;
+        }
+
+        //there are no naked singles, look for a digit that fits in only one
+        //cell of a house
+        int progress = 0;
+        for (int d = 0; d < BITBOARD_DIGITS; d++)
+        {
+            for (int h = 0; h < 27; h++)
+            {
+                CellMask in_house = mask_and(s->candidates[d], HOUSE_MASKS[h]);
+                //the digit has nowhere to go in this house
+                if (mask_is_empty(in_house))
+                    return BITBOARD_CONTRADICTION;
+                if (mask_is_single(in_house))
+                {
+                    int index = cell_mask_pop(&in_house);
+                    //a cell where the digit is already placed is not news
+                    if (CELL_MASK_HAS(s->empty, index))
+                    {
+                        bitboard_place(b, s, d, index);
+                        progress = 1;
+                    }
+                }
+            }
+        }
+
+        if (!progress)
+            return BITBOARD_STUCK;
+    }
+
+    return BITBOARD_SOLVED;
+}
+
+/**
+ * This function picks the empty cell with the fewest candidates
+ */
+static int bitboard_pick_cell(BitboardState *s)
+{
+    CellMask ones, twos, threes;
+    bitboard_count_candidates(s, &ones, &twos, &threes);
+
+    //a cell with exactly two candidates is as good as it gets, since all
+    //the singles have been filled in
+    CellMask pairs = {{twos.band[0] & ~threes.band[0], twos.band[1] & ~threes.band[1],
+                       twos.band[2] & ~threes.band[2]}};
+    if (!mask_is_empty(pairs))
+        return cell_mask_pop(&pairs);
+
+    //otherwise count the candidates of every empty cell
+    CellMask empty = s->empty;
+    int best = -1;
+    int best_count = BITBOARD_DIGITS + 1;
+    int index;
+    while ((index = cell_mask_pop(&empty)) >= 0)
+    {
+        int count = 0;
+        for (int d = 0; d < BITBOARD_DIGITS; d++)
+            count += CELL_MASK_HAS(s->candidates[d], index);
+        if (count < best_count)
+        {
+            best = index;
+            best_count = count;
+        }
+    }
+    return best;
+}
+
+/**
+ * This function solves the sudoku from a state by propagating singles and
+ * guessing when it gets stuck. The search stops once b->limit solutions have
+ * been found, the first one is kept in b->first. Returns true once the limit
+ * is reached
+ */
+static int bitboard_search(Bitboard *b, BitboardState *s)
+{
+    if (b->cancel != NULL && atomic_load_explicit(b->cancel, memory_order_relaxed))
+        return 1;
+
+    int r = bitboard_propagate(b, s);
+    if (r == BITBOARD_SOLVED)
+    {
+        //the values of the branches that failed are all overwritten by now
+        if (b->solutions == 0)
+            memcpy(b->first, b->values, SUDOKU_CELLS);
+        return ++b->solutions >= b->limit;
+    }
+    if (r != BITBOARD_STUCK)
+        return 0;
+
+    int index = bitboard_pick_cell(s);
+    for (int d = 0; d < BITBOARD_DIGITS; d++)
+    {
+        if (!CELL_MASK_HAS(s->candidates[d], index))
+            continue;
+
+        //try the digit on a copy, so that the state is untouched if it fails
+        BitboardState guess = *s;
+        b->steps++;
+        bitboard_place(b, &guess, d, index);
+        if (bitboard_search(b, &guess))
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * This function places the givens of the sudoku in a state where every digit
+ * can go everywhere. Returns false if a given doesn't fit
+ */
+int bitboard_start(Bitboard *b, BitboardState *s)
+{
+    for (int d = 0; d < BITBOARD_DIGITS; d++)
+    {
+        s->candidates[d].band[0] = s->candidates[d].band[1] = s->candidates[d].band[2] = 0x7ffffff;
+    }
+    s->empty = s->candidates[0];
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        int digit = b->values[i] - 1;
+        if (digit < 0)
+            continue;
+        if (!CELL_MASK_HAS(s->candidates[digit], i) || !CELL_MASK_HAS(s->empty, i))
+            return 0;
+        bitboard_place(b, s, digit, i);
+    }
+    return 1;
+}
+
+/**
+ * This function is a single node of the search for searches that split the
+ * tree themselves. It propagates the state and, if it gets stuck, writes a
+ * child for every candidate of the cell with the fewest of them. Returns
+ * the number of children, 0 if the state is solved and -1 if it has no
+ * solution. The children are counted as guesses in the steps
+ */
+int bitboard_expand(Bitboard *b, BitboardState *s, BitboardState *children)
+{
+    int r = bitboard_propagate(b, s);
+    if (r == BITBOARD_SOLVED)
+        return 0;
+    if (r != BITBOARD_STUCK)
+        return -1;
+
+    int index = bitboard_pick_cell(s);
+    int count = 0;
+    for (int d = 0; d < BITBOARD_DIGITS; d++)
+    {
+        if (!CELL_MASK_HAS(s->candidates[d], index))
+            continue;
+        children[count] = *s;
+        bitboard_place(b, &children[count++], d, index);
+    }
+    b->steps += count;
+    return count;
+}
+
+/**
+ * This function writes the values of a state, the values of the
+ * bitboard are only right along the path the search took
+ */
+void bitboard_state_values(BitboardState *s, uint8_t *values)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        values[i] = 0;
+        for (int d = 0; d < BITBOARD_DIGITS; d++)
+        {
+            if (CELL_MASK_HAS(s->candidates[d], i) && !CELL_MASK_HAS(s->empty, i))
+                values[i] = (uint8_t)(d + 1);
+        }
+    }
+}
+
+/**
+ * This function loads a sudoku from a string, every char that is not
+ * a digit from 1 to 9 is an empty cell
+ */
+void bitboard_load_from_char(Bitboard *b, char *data)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        char c = data[i];
+        b->values[i] = (c >= '1' && c <= '9') ? (uint8_t)(c - '0') : 0;
+    }
+    b->steps = 0;
+    b->cancel = NULL;
+}
+
+/**
+ * This function returns how many cells are empty
+ */
+int bitboard_get_empty_count(Bitboard *b)
+{
+    int count = 0;
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        count += b->values[i] == 0;
+    }
+    return count;
+}
+
+/**
+ * This function counts the solutions of a sudoku with the bitboard engine, up
+ * until there are limit of them. The values of the first solution are kept, the
+ * result is one of the result codes of sudoku_solve and the steps are the
+ * guesses that were made
+ */
+void bitboard_count_solutions(Bitboard *b, int limit, int *result, int *count, int *steps)
+{
+    b->steps = 0;
+    b->solutions = 0;
+    b->limit = limit;
+
+    //a given that doesn't fit makes the sudoku unsolvable
+    BitboardState s;
+    if (bitboard_start(b, &s))
+        bitboard_search(b, &s);
+
+    if (b->solutions > 0)
+        memcpy(b->values, b->first, SUDOKU_CELLS);
+
+    *result = (b->solutions > 0) ? SUDOKU_SOLVED : SUDOKU_NO_SOLUTUION;
+    //the count of a search that was stopped is not complete
+    if (b->cancel != NULL && atomic_load_explicit(b->cancel, memory_order_relaxed) && b->solutions < limit)
+        *result = SUDOKU_UNDECIDED;
+    *count = b->solutions;
+    *steps = b->steps;
+}
+
+/**
+ * This function solves a sudoku with the bitboard engine, the search stops
+ * at the first solution
+ */
+void bitboard_solve(Bitboard *b, int *result, int *steps)
+{
+    int count;
+    bitboard_count_solutions(b, 1, result, &count, steps);
+}
+
+/**
+ * This function writes the values of the sudoku in a buffer of 82 chars,
+ * if no buffer is provided one is allocated
+ */
+char *bitboard_to_string_simple(Bitboard *b, char *buff)
+{
+    //WARNING: This needs to be freed by someone but not us
+    if (buff == NULL)
+    {
+        buff = (char *)malloc((SUDOKU_CELLS + 1) * sizeof(char));
+    }
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        buff[i] = (char)(b->values[i] + '0');
+    }
+    buff[SUDOKU_CELLS] = '\0';
+
+    return buff;
+}
@@ -0,0 +1,50 @@
+#if !defined(BITBOARD_H)
+#define BITBOARD_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "tables.h"
+
+#define BITBOARD_DIGITS 9
+
+/**
+ * The state of the bitboard engine that changes while searching. It is small
+ * enough that every guess works on its own copy, so backtracking is just
+ * throwing the copy away
+ */
+typedef struct _BitboardState
+{
+    //candidates[d] holds the cells where digit d + 1 can still be placed,
+    //together with the cells where it has been placed
+    CellMask candidates[BITBOARD_DIGITS];
+    //the cells that are not filled in yet
+    CellMask empty;
+} BitboardState;
+
+/**
+ * A sudoku for the bitboard engine. The values are the givens before
+ * solving and the solution after a successful solve
+ */
+typedef struct _Bitboard
+{
+    uint8_t values[SUDOKU_CELLS];
+    //how many guesses the search made
+    int steps;
+    //the solutions found so far, how many we look for and the first one
+    int solutions;
+    int limit;
+    uint8_t first[SUDOKU_CELLS];
+    //the search gives up once this is set, loading a sudoku sets it to NULL
+    atomic_int *cancel;
+} Bitboard;
+
+void bitboard_load_from_char(Bitboard *b, char *data);
+int bitboard_start(Bitboard *b, BitboardState *s);
+int bitboard_expand(Bitboard *b, BitboardState *s, BitboardState *children);
+void bitboard_state_values(BitboardState *s, uint8_t *values);
+int bitboard_get_empty_count(Bitboard *b);
+void bitboard_solve(Bitboard *b, int *result, int *steps);
+void bitboard_count_solutions(Bitboard *b, int limit, int *result, int *count, int *steps);
+char *bitboard_to_string_simple(Bitboard *b, char *buff);
+
+#endif // BITBOARD_H
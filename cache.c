@@ -0,0 +1,103 @@
+#include "cache.h"
+
+/**
+ * The solved sudokus are kept by their canonical form, so a sudoku that is a
+ * transformation of one that was solved before is answered by mapping its
+ * solution back. The table uses open addressing with linear probing, the
+ * entries are never removed. Lookups share the lock, inserts take it alone
+ */
+
+/**
+ * This function creates an empty cache with at least capacity slots, a power
+ * of two. It has at least 4 of them, so that filling it up to three quarters
+ * always leaves an empty slot where the probing of a missing key ends
+ */
+SolvedCache *create_solved_cache(int capacity)
+{
+    SolvedCache *c = (SolvedCache *)malloc(sizeof(SolvedCache));
+    c->capacity = 4;
+    while (c->capacity < capacity)
+    {
+        c->capacity <<= 1;
+    }
+    c->size = 0;
+    c->entries = (SolvedCacheEntry *)calloc(c->capacity, sizeof(SolvedCacheEntry));
+    pthread_rwlock_init(&c->lock, NULL);
+    return c;
+}
+
+void solved_cache_free(SolvedCache *c)
+{
+    pthread_rwlock_destroy(&c->lock);
+    free(c->entries);
+    free(c);
+}
+
+/**
+ * This function hashes a canonical form eight cells at a time
+ */
+static uint64_t solved_cache_hash(const uint8_t *key)
+{
+    uint64_t h = 0;
+    for (int i = 0; i < SUDOKU_CELLS; i += 8)
+    {
+        uint64_t word = 0;
+        memcpy(&word, &key[i], (SUDOKU_CELLS - i < 8) ? SUDOKU_CELLS - i : 8);
+        h = (h ^ word) * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+/**
+ * This function returns the slot of a key, which is either
+ * its entry or the empty slot where it would go
+ */
+static SolvedCacheEntry *solved_cache_slot(SolvedCache *c, const uint8_t *key)
+{
+    int mask = c->capacity - 1;
+    int i = (int)(solved_cache_hash(key) & mask);
+    while (c->entries[i].used && memcmp(c->entries[i].key, key, SUDOKU_CELLS) != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    return &c->entries[i];
+}
+
+/**
+ * This function copies the entry of a canonical form. Returns
+ * false if the form was not solved before
+ */
+int solved_cache_find(SolvedCache *c, const uint8_t *key, SolvedCacheEntry *entry)
+{
+    pthread_rwlock_rdlock(&c->lock);
+    SolvedCacheEntry *slot = solved_cache_slot(c, key);
+    int found = slot->used;
+    if (found)
+        *entry = *slot;
+    pthread_rwlock_unlock(&c->lock);
+    return found;
+}
+
+/**
+ * This function adds a solved canonical form, if there is room
+ * and another worker didn't add it first
+ */
+void solved_cache_insert(SolvedCache *c, const uint8_t *key, int result, int solutions, const uint8_t *values)
+{
+    pthread_rwlock_wrlock(&c->lock);
+    if (c->size * 4 < c->capacity * 3)
+    {
+        SolvedCacheEntry *slot = solved_cache_slot(c, key);
+        if (!slot->used)
+        {
+            memcpy(slot->key, key, SUDOKU_CELLS);
+            memcpy(slot->values, values, SUDOKU_CELLS);
+            slot->result = (int8_t)result;
+            slot->solutions = solutions;
+            slot->used = 1;
+            c->size++;
+        }
+    }
+    pthread_rwlock_unlock(&c->lock);
+}
@@ -0,0 +1,43 @@
+#if !defined(CACHE_H)
+#define CACHE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "tables.h"
+
+#define SOLVED_CACHE_DEFAULT_CAPACITY (1 << 16)
+
+/**
+ * A solved sudoku in canonical form
+ */
+typedef struct _SolvedCacheEntry
+{
+    uint8_t key[SUDOKU_CELLS];
+    //the solution in canonical form
+    uint8_t values[SUDOKU_CELLS];
+    uint8_t used;
+    int8_t result;
+    int solutions;
+} SolvedCacheEntry;
+
+/**
+ * A hash table of solved canonical forms that the workers share. It never
+ * grows, once it is three quarters full new sudokus are not added
+ */
+typedef struct _SolvedCache
+{
+    //a power of two
+    int capacity;
+    int size;
+    SolvedCacheEntry *entries;
+    pthread_rwlock_t lock;
+} SolvedCache;
+
+SolvedCache *create_solved_cache(int capacity);
+void solved_cache_free(SolvedCache *c);
+int solved_cache_find(SolvedCache *c, const uint8_t *key, SolvedCacheEntry *entry);
+void solved_cache_insert(SolvedCache *c, const uint8_t *key, int result, int solutions, const uint8_t *values);
+
+#endif // CACHE_H
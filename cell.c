@@ -2,114 +2,70 @@
 #include "utils.h"
 
 /**
- * A cell instance represents a sudoku cell. Each cell has a value which is the
- * "filled in" value of the cell. The index represents the cell's position in the
- * sudoku. It can range from 0 to 80. The neighbors array contains the indeces of
- * cells to which the cell is adjecent (there must exist no two cells that are
- * adjecent and have the same value). The pencilmakrs stack represents the values
- * that when filled in the sudoku would still be valid.
+ * A cell is not an object of its own. It is identified by its index, which
+ * represents the cell's position in the sudoku. It can range from 0 to 80.
+ * The value of a cell is the "filled in" value, and it lives in the values
+ * array of the sudoku at that index. The pencilmarks of a cell represent the
+ * values that when filled in the sudoku would still be valid, they live in the
+ * pencilmarks array of the sudoku at the same index. The neighbors of a cell
+ * are the indeces of cells to which the cell is adjecent (there must exist no
+ * two cells that are adjecent and have the same value). The neighbors of every
+ * cell are the same for every sudoku so they are held in the constant tables.
+ *
+ * The functions in this file receive the index of the cell they work on
+ * together with the flat arrays of the sudoku, so no memory is allocated
+ * for a cell at any point.
  */
 
-/*
- * This function creates/returns an "empty" cell instance. It has an empty value
- * and no position in the puzzle. It allocates the appropriate memory for the
- * neighbors array and the pencilmakrs stack.
- */
-Cell *create_cell()
-{
-    Cell *c = (Cell *)malloc(sizeof(Cell));
-    c->value = 0;
-    c->index = -1;
-    c->neighbors = (int *)malloc(sizeof(int) * 20);
-    c->row_neighbors = (int *)malloc(sizeof(int) * 8);
-    c->col_neighbors = (int *)malloc(sizeof(int) * 8);
-    c->box_neighbors = (int *)malloc(sizeof(int) * 8);
-    c->pencilmakrs = pencilmarks_set_create();
-    return c;
-}
-
-/*
- * This function frees a cell instance from memory. First it frees the allocated
- * memory for the neighbors array and the pencilmakrs stack and then frees the
- * space used by itself.
- */
-void free_cell(Cell *c)
-{
-    free(c->neighbors);
-    free(c->row_neighbors);
-    free(c->col_neighbors);
-    free(c->box_neighbors);
-    pencilmarks_set_free(c->pencilmakrs);
-    free(c);
-}
-
-/*
- * This function creates a sudoku cell with a specific value and position. First
- * it allocates the necessary memory to create a generic cell and then applies the
- * specific values. After that it also calculates the indeces of the cells to which
- * this cell is adjecent.
- */
-Cell *add_cell(int val, int index)
-{
-    Cell *c = create_cell();
-    c->value = val;
-    c->index = index;
-    cell_calculate_neighbor_indeces(c);
-    return c;
-}
-
 /*
  * This function gets the x component of the position of a cell on the 2d grid grid
  * that represents the sudoku puzzle.
  */
-int cell_calculate_x(Cell *c)
+int cell_calculate_x(int index)
 {
-    return c->index % 9;
+    return CELL_X[index];
 }
 
 /*
  * This function gets the y component of the position of a cell on the 2d grid grid
- * that represents the sudoku puzzle. 
+ * that represents the sudoku puzzle.
 */
-int cell_calculate_y(Cell *c)
+int cell_calculate_y(int index)
 {
-    return (int)(c->index / 9);
+    return CELL_Y[index];
 }
 
 /*
- * This function uses the fact that x + y * width is injective. It finds
- * to which box a cell belongs using the x,y components of its 2d position and
- * maps that pair to a 1d value. That is used to identify each 3x3 box on the grid
+ * This function finds to which box a cell belongs. Boxes are numbered from
+ * left to right and from top to bottom, that is used to identify each 3x3
+ * box on the grid
  */
-int cell_calculate_box(Cell *c)
+int cell_calculate_box(int index)
 {
-    int bx = cell_calculate_x(c) / 3;
-    int by = cell_calculate_y(c) / 3;
-
-    return bx + by * 3;
+    return CELL_BOX[index];
 }
 
 /**
  * This function returns true when a cell is filled in or not
  */
-int cell_is_empty(Cell *c)
+int cell_is_empty(uint8_t *values, int index)
 {
-    return c->value == 0;
+    return values[index] == 0;
 }
 
 /**
- * This function finds the pencilmark of the cell that is least frequantly 
+ * This function finds the pencilmark of the cell that is least frequantly
  * filled in the sudkoku, since it's the most likely to be correct
  */
-int cell_retrieve_next_value_from_pencilmarks(Cell *c, int *value_freq)
+int cell_retrieve_next_value_from_pencilmarks(PSet *ps, int *value_freq)
 {
     //if we have no choise we can directly pop the value from the stack
-    if (pencilmarks_set_get_size(c->pencilmakrs) < 2)
+    if (pencilmarks_set_get_size(ps) < 2)
     {
-        return pencilmarks_set_pop_value(c->pencilmakrs);
+        return pencilmarks_set_pop_value(ps);
     }
 
-    int mask = c->pencilmakrs->mask;
+    int mask = *ps;
 
     int val = 31 - leading_zeros(mask);
     mask &= ~(1 << val);
@@ -130,210 +86,140 @@ int cell_retrieve_next_value_from_pencilmarks(Cell *c, int *value_freq)
     }
 
     //remove the value from the pencilmarks
-    pencilmarks_set_remove_pencilmark(c->pencilmakrs, val);
+    pencilmarks_set_remove_pencilmark(ps, val);
 
     //return the pencilmark
     return val;
 }
 
-/*
- * This function calculates the indeces of the cells to which a cell is adjecent.
- * Two cells are adjecent if any of their x,y,box components are equal. Also no
- * cell is adjecent to itself. Each cell should have 20 neighbors. This function 
- * should only be called once when the cell is initialized.
+/**
+ * This function takes the next value to try out of the pencilmarks of a cell,
+ * either the lowest one or the one that is most frequently filled in
  */
-void cell_calculate_neighbor_indeces(Cell *c)
+int cell_retrieve_value_in_order(PSet *ps, int *value_freq, int most_frequent)
 {
-    //calculate the x,y,box of the cell
-    int cx = cell_calculate_x(c);
-    int cy = cell_calculate_y(c);
-    int cb = cell_calculate_box(c);
-
-    //create a token cell that will be used to calculate the x,y,box components
-    //of other cells
-    Cell *other = create_cell();
-
-    //a counter to know how many cells have been found
-    int neigbor_counter = 0;
-    int neigbor_row_counter = 0;
-    int neigbor_col_counter = 0;
-    int neigbor_box_counter = 0;
-
-    //loop over all possible indeces
-    for (int i = 0; i < 81; i++)
+    if (pencilmarks_set_get_size(ps) < 2 || !most_frequent)
     {
-        //set the index of the token cell to the one we work with now
-        other->index = i;
-
-        //a cell should not be adjecent to itself
-        if (other->index == c->index)
-            continue;
-
-        //calculate the x,y,box components of that cell
-        int ox = cell_calculate_x(other);
-        int oy = cell_calculate_y(other);
-        int ob = cell_calculate_box(other);
+        return pencilmarks_set_pop_value(ps);
+    }
 
-        //if the two cells have any components that are equal, then
-        //they should be adjecent
-        if (cx == ox || cy == oy || cb == ob)
-        {
-            //add that index to the neighbors array
-            c->neighbors[neigbor_counter] = i;
-            //increament the counter
-            neigbor_counter++;
-            if (cx == ox)
-            {
-                c->col_neighbors[neigbor_col_counter] = i;
-                neigbor_col_counter++;
-            }
-            if (cy == oy)
-            {
-                c->row_neighbors[neigbor_row_counter] = i;
-                neigbor_row_counter++;
-            }
-            if (cb == ob)
-            {
-                c->box_neighbors[neigbor_box_counter] = i;
-                neigbor_box_counter++;
-            }
-        }
+    int mask = *ps;
+    int val = trailing_zeros(mask);
+    mask &= ~(1 << val);
+    while (mask)
+    {
+        int candidate_value = trailing_zeros(mask);
+        if (value_freq[candidate_value] > value_freq[val])
+            val = candidate_value;
+        mask &= ~(1 << candidate_value);
     }
 
-    //after we are done we can free the memory tha was used by the token cell
-    free_cell(other);
+    pencilmarks_set_remove_pencilmark(ps, val);
+    return val;
 }
 
 /*
  * This function calculates the pencilmakrs of a cell. Then pencilmakrs of a cell
  * are affected by the values of its neighbors. A value between [1,...,9] should be
- * in the pencilmakrs stack iff there exists no neighbor such that it has that value
- * as a its own value.
+ * in the pencilmakrs set iff there exists no neighbor such that it has that value
+ * as a its own value. The values of the neighbors are given as the union of the
+ * values that are used in the row, column and box of the cell.
  */
-void cell_calculate_pencilmarks(Cell *c, Cell **sud)
+void cell_calculate_pencilmarks(int index, uint8_t *values, PSet *pencilmarks, PSet used)
 {
     //if the cell is not empty we don't bother with calculating the pencilmakrs
     //at all
-    if (c->value != 0)
+    if (values[index] != 0)
         return;
 
-    //remove any values that are already in the pencilmakrs stack
-    pencilmarks_set_clear(c->pencilmakrs);
-    //for each value in [1,...,9]
-    for (int val = 1; val <= 9; val++)
-    {
-        //assume the value will go in the pencilmakrs stack
-        int still_valid = 1;
-
-        //iterate over all the neighbor indeces
-        for (int i = 0; i < 20; i++)
-        {
-            //the index of the i'th neighbor
-            int n_index = c->neighbors[i];
-
-            //the neighbour
-            Cell *ne = sud[n_index];
-
-            //if the neighbor has the same value as the one we are currently
-            //inspecting
-            if (ne->value == val)
-            {
-                //this value will not go in the pencilmakrs stack
-                still_valid = 0;
-
-                //we dont need to iterate over the rest of neighbors
-                break;
-            }
-        }
-
-        //if it turns out that the value can go in the pencilmakrs stack
-        if (still_valid)
-        {
-            //push that value in the pencilmakrs stack
-            pencilmarks_set_add_pencilmark(c->pencilmakrs, val);
-        }
-    }
+    //every value that no neighbor has goes in the pencilmarks set
+    pencilmarks[index] = ALL_PENCILMARKS & ~used;
 }
 
 /**
  * This function finds whether an empty cell has a unique pencilmark
  * compared to all the other empty cells of one of its houses (row, column, box)
- * It receives a cell as input, as well as the cell array that defines the sudoku
+ * It receives a cell index as input, as well as the arrays that define the sudoku
  * and a list of indeces that are in the same row, column or box as this cell.
  */
-int cell_find_unique_pencilmarks(Cell *c, Cell **sud, int *house_indeces)
+int cell_find_unique_pencilmarks(int index, uint8_t *values, PSet *pencilmarks, const uint8_t *house_indeces)
 {
+    PSet *ps = &pencilmarks[index];
+
     //if the cell has at most one pencilmark, then obviously we don't need
     //to consider it
-    if (pencilmarks_set_get_size(c->pencilmakrs) < 2)
+    if (pencilmarks_set_get_size(ps) < 2)
         return 0;
 
-    int penclimarks_mask = c->pencilmakrs->mask;
+    int penclimarks_mask = *ps;
 
     //for every cell that is in that house
     for (int i = 0; i < 9; i++)
     {
-        Cell *n = sud[house_indeces[i]];
+        int n = house_indeces[i];
         //if it's the same cell as the one we are observing then we can ignore it
-        if (n->index == c->index)
+        if (n == index)
             continue;
         //if it's filled in then we also ignore it
-        if (n->value != 0)
+        if (values[n] != 0)
             continue;
 
         //make every position that a neighboring cell contains a
         //pencilmark a zero
-        penclimarks_mask &= ~(n->pencilmakrs->mask);
+        penclimarks_mask &= ~(pencilmarks[n]);
 
         if (penclimarks_mask == 0)
             break;
     }
 
-    //if in the end the cloned stack has exactly one value
+    //if in the end the mask has exactly one value
     //that means that this cell, has a unique pencilmark in this house
     if (is_power_of_two(penclimarks_mask))
     {
         //get the unique pencilmark
         int unique_pencilmark = trailing_zeros(penclimarks_mask);
         //remove all the values from the pencilmarks set
-        pencilmarks_set_clear(c->pencilmakrs);
+        pencilmarks_set_clear(ps);
         //add the unique pencilmark
-        pencilmarks_set_add_pencilmark(c->pencilmakrs, unique_pencilmark);
+        pencilmarks_set_add_pencilmark(ps, unique_pencilmark);
     }
 
-    //and return true if anything changed in the stack of that cell
-    return pencilmarks_set_get_size(c->pencilmakrs) == 1;
+    //and return true if anything changed in the set of that cell
+    return pencilmarks_set_get_size(ps) == 1;
 }
 
 /**
  * TODO: fix this function it is broken
- * 
+ *
  */
-void cell_pointing_pair(Cell *c, Cell **sud, int *row_indeces, int *col_indeces, int *box_indeces)
+void cell_pointing_pair(int index, uint8_t *values, PSet *pencilmarks, const uint8_t *row_indeces,
+                        const uint8_t *col_indeces, const uint8_t *box_indeces)
 {
 
-    if (!cell_is_empty(c))
+    if (!cell_is_empty(values, index))
         return;
 
-    if (pencilmarks_set_get_size(c->pencilmakrs) != 2)
+    PSet *ps = &pencilmarks[index];
+
+    if (pencilmarks_set_get_size(ps) != 2)
         return;
 
-    int row_mask = c->pencilmakrs->mask;
-    int col_mask = c->pencilmakrs->mask;
+    int row_mask = *ps;
+    int col_mask = *ps;
 
-    int our_x = cell_calculate_x(c);
-    int our_y = cell_calculate_y(c);
-    int our_b = cell_calculate_box(c);
+    int our_x = cell_calculate_x(index);
+    int our_y = cell_calculate_y(index);
+    int our_b = cell_calculate_box(index);
 
     for (int i = 0; i < 9; i++)
     {
-        Cell *other = sud[box_indeces[i]];
-        if (c == other || !cell_is_empty(other))
+        int other = box_indeces[i];
+        if (index == other || !cell_is_empty(values, other))
             continue;
 
         int other_x = cell_calculate_x(other);
         int other_y = cell_calculate_y(other);
-        int other_mask = other->pencilmakrs->mask;
+        int other_mask = pencilmarks[other];
 
         //looking for same collumn
         if (our_x == other_x)
@@ -362,44 +248,29 @@ void cell_pointing_pair(Cell *c, Cell **sud, int *row_indeces, int *col_indeces,
 
     if (do_rows || do_cols)
     {
-
-        // for (int i = 0; i < 9; i++)
-        // {
-        //     Cell *tc = sud[box_indeces[i]];
-        //     if (c == tc)
-        //         printf("-");
-        //     printf("(%d,%d) ", cell_calculate_x(tc), cell_calculate_y(tc));
-        //     pencilmarks_set_print(tc->pencilmakrs);
-        // }
-        // getchar();
         for (int i = 0; i < 9; i++)
         {
             if (do_rows)
             {
-                Cell *other_row_cell = sud[row_indeces[i]];
+                int other_row_cell = row_indeces[i];
                 int other_row_b = cell_calculate_box(other_row_cell);
 
-                if (cell_is_empty(other_row_cell) && (our_b != other_row_b) && !pencilmarks_set_equals(c->pencilmakrs, other_row_cell->pencilmakrs))
+                if (cell_is_empty(values, other_row_cell) && (our_b != other_row_b) &&
+                    !pencilmarks_set_equals(ps, &pencilmarks[other_row_cell]))
                 {
-                    // printf("%d, %d\n", row_val1, row_val2);
-                    // pencilmarks_set_print(other_row_cell->pencilmakrs);
-
-                    pencilmarks_set_remove_pencilmark(other_row_cell->pencilmakrs, row_val1);
-                    pencilmarks_set_remove_pencilmark(other_row_cell->pencilmakrs, row_val2);
-                    // pencilmarks_set_print(other_row_cell->pencilmakrs);
-
-                    // getchar();
+                    pencilmarks_set_remove_pencilmark(&pencilmarks[other_row_cell], row_val1);
+                    pencilmarks_set_remove_pencilmark(&pencilmarks[other_row_cell], row_val2);
                 }
             }
             if (do_cols)
             {
-                Cell *other_col_cell = sud[col_indeces[i]];
+                int other_col_cell = col_indeces[i];
                 int other_col_b = cell_calculate_box(other_col_cell);
 
-                if (cell_is_empty(other_col_cell) && (our_b != other_col_b))
+                if (cell_is_empty(values, other_col_cell) && (our_b != other_col_b))
                 {
-                    // pencilmarks_set_remove_pencilmark(other_col_cell->pencilmakrs, col_val1);
-                    // pencilmarks_set_remove_pencilmark(other_col_cell->pencilmakrs, col_val2);
+                    // pencilmarks_set_remove_pencilmark(&pencilmarks[other_col_cell], col_val1);
+                    // pencilmarks_set_remove_pencilmark(&pencilmarks[other_col_cell], col_val2);
                 }
             }
         }
@@ -408,37 +279,34 @@ void cell_pointing_pair(Cell *c, Cell **sud, int *row_indeces, int *col_indeces,
 
 /**
  * Finds neighbouring cells that have the exact same pencilmarks as this one in the house
- * If a cell has as many neighbours that fullfill the above predicate then, we can remove 
+ * If a cell has as many neighbours that fullfill the above predicate then, we can remove
  * these pencilmarks from the rest of the cells
  */
-void cell_find_naked_partners(Cell *c, Cell **sud, int *house_indeces)
+void cell_find_naked_partners(int index, uint8_t *values, PSet *pencilmarks, const uint8_t *house_indeces)
 {
     //if the cell is not empty then we don't want to bother with it
-    if (!cell_is_empty(c))
+    if (!cell_is_empty(values, index))
         return;
 
+    PSet *ps = &pencilmarks[index];
+
     //if the cell doesn't have any ambigiouity then there is no point finding
     //partenrs for it
-    if (pencilmarks_set_get_size(c->pencilmakrs) < 2)
+    if (pencilmarks_set_get_size(ps) < 2)
         return;
 
-    //if the cell has more than 3 cells, the chances that it will
-    //have another cell in the house with the same pencilmarks is
-    //very small, so cutoff from 3
-    // if (stack_get_size(c->pencilmakrs) > 3)
-    //     return;
-
     //the cells that have the exact same pencilmarks
-    Cell *same_pencilmarks[9];
+    int same_pencilmarks[9];
     int num_same;
     //the cells that are empty and don't have the exact same pencilmarks as c
-    Cell *complements[9];
+    int complements[9];
     int num_comp;
 
-    cell_get_neighbours_with_same_pencilmarks_in_house(c,                /*the cell*/
-                                                       sud,              /*the sudoku cells array*/
+    cell_get_neighbours_with_same_pencilmarks_in_house(index,            /*the cell*/
+                                                       values,           /*the values of the sudoku*/
+                                                       pencilmarks,      /*the pencilmarks of the sudoku*/
                                                        house_indeces,    /*the indeces of the cells in this house*/
-                                                       same_pencilmarks, /*the buffer were the cells that have 
+                                                       same_pencilmarks, /*the buffer were the cells that have
                                                        the same pencilmarks as c will be put*/
                                                        &num_same,        /*the number of cells that have the same pencilmarks will be written in this variable*/
                                                        complements,      /*the cells that are empty and don't have the same pencilmarks as c will be put in here*/
@@ -446,14 +314,14 @@ void cell_find_naked_partners(Cell *c, Cell **sud, int *house_indeces)
 
     //if we didn't find as many valid cells as we have pencilmarks
     //then we can't do much more
-    if (num_same != pencilmarks_set_get_size(c->pencilmakrs) - 1)
+    if (num_same != pencilmarks_set_get_size(ps) - 1)
         return;
 
     //for every complement cell, remove our pencilmarks from their pencilmarks
     for (int i = 0; i < num_comp; i++)
     {
-        Cell *to_remove_from = complements[i];
-        to_remove_from->pencilmakrs->mask = pencilmarks_set_difference(to_remove_from->pencilmakrs, c->pencilmakrs);
+        PSet *to_remove_from = &pencilmarks[complements[i]];
+        *to_remove_from = pencilmarks_set_difference(to_remove_from, ps);
     }
 }
 
@@ -461,27 +329,28 @@ void cell_find_naked_partners(Cell *c, Cell **sud, int *house_indeces)
  * This function returns the number of neighbors in a house that have the exact same
  * pencilmarks as a given cell
  */
-void cell_get_neighbours_with_same_pencilmarks_in_house(Cell *c, Cell **sud, int *house_indeces, Cell **same_buffer,
-                                                        int *same_num, Cell **comp_buffer, int *comp_num)
+void cell_get_neighbours_with_same_pencilmarks_in_house(int index, uint8_t *values, PSet *pencilmarks,
+                                                        const uint8_t *house_indeces, int *same_buffer,
+                                                        int *same_num, int *comp_buffer, int *comp_num)
 {
     int same_counter = 0;
     int comp_counter = 0;
 
-    PSet *our_pencilmarks = c->pencilmakrs;
+    PSet *our_pencilmarks = &pencilmarks[index];
     PSet *other_pencilmarks = NULL;
     //for every cell in the house
     for (int i = 0; i < 9; i++)
     {
 
-        Cell *other = sud[house_indeces[i]];
+        int other = house_indeces[i];
         //if the other cell is the same as the main one ignore it
-        if (other == c)
+        if (other == index)
             continue;
         //if the other cell has a value in it, ignore it
-        if (!cell_is_empty(other))
+        if (!cell_is_empty(values, other))
             continue;
 
-        other_pencilmarks = other->pencilmakrs;
+        other_pencilmarks = &pencilmarks[other];
 
         //if the main cell and the other one have the
         //exact same pencilmarks, then add the other
@@ -503,4 +372,4 @@ void cell_get_neighbours_with_same_pencilmarks_in_house(Cell *c, Cell **sud, int
 
     *same_num = same_counter;
     *comp_num = comp_counter;
-}
\ No newline at end of file
+}
@@ -0,0 +1,299 @@
+#include "dlx.h"
+#include "sudoku.h"
+
+/**
+ * An exact cover engine that uses Knuth's dancing links. Every row of the
+ * matrix fills in a value in a cell and covers four columns: the cell itself
+ * and the value in the row, the column and the box of the cell. A solution is
+ * a set of 81 rows that covers every column exactly once.
+ *
+ * The search always branches on the column with the fewest rows, so cells and
+ * values with a single option are filled in first, without any guessing.
+ */
+
+/**
+ * This function returns the matrix column of a constraint
+ */
+static int dlx_column_of(int constraint, int index, int value)
+{
+    switch (constraint)
+    {
+    case 0: //the cell has a value
+        return 1 + index;
+    case 1: //the row of the cell has the value
+        return 1 + 81 + cell_calculate_y(index) * 9 + value;
+    case 2: //the column of the cell has the value
+        return 1 + 162 + cell_calculate_x(index) * 9 + value;
+    default: //the box of the cell has the value
+        return 1 + 243 + cell_calculate_box(index) * 9 + value;
+    }
+}
+
+/**
+ * This function creates the matrix of the sudoku exact cover problem
+ */
+Dlx *create_dlx()
+{
+    Dlx *d = (Dlx *)malloc(sizeof(Dlx));
+    d->cancel = NULL;
+
+    //the root and the column headers form a circular list
+    for (int i = 0; i <= DLX_COLUMNS; i++)
+    {
+        d->left[i] = (i == 0) ? DLX_COLUMNS : i - 1;
+        d->right[i] = (i == DLX_COLUMNS) ? 0 : i + 1;
+        d->up[i] = i;
+        d->down[i] = i;
+        d->column[i] = i;
+        d->size[i] = 0;
+    }
+
+    //add the four nodes of every row
+    int node = DLX_COLUMNS + 1;
+    for (int r = 0; r < DLX_ROWS; r++)
+    {
+        int index = r / 9;
+        int value = r % 9;
+        for (int k = 0; k < 4; k++, node++)
+        {
+            int col = dlx_column_of(k, index, value);
+
+            //the nodes of the row form a circular list
+            d->left[node] = (k == 0) ? node + 3 : node - 1;
+            d->right[node] = (k == 3) ? node - 3 : node + 1;
+
+            //put the node at the bottom of its column
+            d->up[node] = d->up[col];
+            d->down[node] = col;
+            d->down[d->up[col]] = node;
+            d->up[col] = node;
+
+            d->column[node] = col;
+            d->row[node] = r;
+            d->size[col]++;
+        }
+    }
+
+    return d;
+}
+
+/**
+ * This function frees the matrix
+ */
+void dlx_free(Dlx *d)
+{
+    free(d);
+}
+
+/**
+ * This function removes a column from the header list and every row that
+ * has a node in that column from the other columns
+ */
+static void dlx_cover(Dlx *d, int col)
+{
+    d->right[d->left[col]] = d->right[col];
+    d->left[d->right[col]] = d->left[col];
+
+    for (int i = d->down[col]; i != col; i = d->down[i])
+    {
+        for (int j = d->right[i]; j != i; j = d->right[j])
+        {
+            d->down[d->up[j]] = d->down[j];
+            d->up[d->down[j]] = d->up[j];
+            d->size[d->column[j]]--;
+        }
+    }
+}
+
+/**
+ * This function undoes dlx_cover, the nodes must be put back in the
+ * opposite order of the one they were removed in
+ */
+static void dlx_uncover(Dlx *d, int col)
+{
+    for (int i = d->up[col]; i != col; i = d->up[i])
+    {
+        for (int j = d->left[i]; j != i; j = d->left[j])
+        {
+            d->size[d->column[j]]++;
+            d->down[d->up[j]] = j;
+            d->up[d->down[j]] = j;
+        }
+    }
+
+    d->right[d->left[col]] = col;
+    d->left[d->right[col]] = col;
+}
+
+/**
+ * This function searches for sets of rows that cover every column that is
+ * left, k rows have been chosen so far. The search stops once d->limit
+ * solutions have been found, the values of the first one are kept. Whether
+ * a solution is found or not, the matrix is the same when it returns as it
+ * was when it was called. Returns true once the limit is reached
+ */
+static int dlx_search(Dlx *d, int k)
+{
+    //nothing is covered yet, so the caller undoes everything as usual
+    if (d->cancel != NULL && atomic_load_explicit(d->cancel, memory_order_relaxed))
+        return 1;
+
+    //every column is covered so the chosen rows are a solution
+    if (d->right[0] == 0)
+    {
+        for (int i = 0; i < k && d->solutions == 0; i++)
+        {
+            d->values[d->chosen[i] / 9] = d->chosen[i] % 9 + 1;
+        }
+        return ++d->solutions >= d->limit;
+    }
+
+    //choose the column with the fewest rows
+    int col = d->right[0];
+    for (int c = d->right[col]; c != 0; c = d->right[c])
+    {
+        if (d->size[c] < d->size[col])
+            col = c;
+    }
+
+    //a constraint nothing can satisfy
+    if (d->size[col] == 0)
+        return 0;
+
+    int found = 0;
+    dlx_cover(d, col);
+    for (int r = d->down[col]; r != col && !found; r = d->down[r])
+    {
+        d->chosen[k] = d->row[r];
+        d->steps++;
+
+        for (int j = d->right[r]; j != r; j = d->right[j])
+            dlx_cover(d, d->column[j]);
+
+        found = dlx_search(d, k + 1);
+
+        for (int j = d->left[r]; j != r; j = d->left[j])
+            dlx_uncover(d, d->column[j]);
+    }
+    dlx_uncover(d, col);
+
+    return found;
+}
+
+/**
+ * This function loads a sudoku from a string, every char that is not
+ * a digit from 1 to 9 is an empty cell
+ */
+void dlx_load_from_char(Dlx *d, char *data)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        char c = data[i];
+        d->values[i] = (c >= '1' && c <= '9') ? (uint8_t)(c - '0') : 0;
+    }
+    d->steps = 0;
+}
+
+/**
+ * This function returns how many cells are empty
+ */
+int dlx_get_empty_count(Dlx *d)
+{
+    int count = 0;
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        count += d->values[i] == 0;
+    }
+    return count;
+}
+
+/**
+ * This function counts the solutions of the loaded sudoku, up until there are
+ * limit of them. The values of the first solution are kept, the result is one
+ * of the result codes of sudoku_solve and the steps are the rows the search tried
+ */
+void dlx_count_solutions(Dlx *d, int limit, int *result, int *count, int *steps)
+{
+    d->steps = 0;
+    d->solutions = 0;
+    d->limit = limit;
+
+    //the givens are chosen before the search starts, the first node
+    //of every row covers the cell so it is the node of the row
+    int givens[SUDOKU_CELLS];
+    int num_givens = 0;
+    int valid = 1;
+    uint8_t covered[1 + DLX_COLUMNS] = {0};
+
+    for (int i = 0; i < SUDOKU_CELLS && valid; i++)
+    {
+        if (d->values[i] == 0)
+            continue;
+
+        int r = DLX_COLUMNS + 1 + 4 * (i * 9 + d->values[i] - 1);
+
+        //two givens that want the same constraint
+        for (int j = r, k = 0; k < 4; j = d->right[j], k++)
+        {
+            if (covered[d->column[j]])
+                valid = 0;
+        }
+        if (!valid)
+            break;
+
+        for (int j = r, k = 0; k < 4; j = d->right[j], k++)
+        {
+            covered[d->column[j]] = 1;
+            dlx_cover(d, d->column[j]);
+        }
+        givens[num_givens++] = r;
+    }
+
+    if (valid)
+        dlx_search(d, 0);
+
+    //put the matrix back the way it was, in the opposite order
+    for (int g = num_givens - 1; g >= 0; g--)
+    {
+        int r = givens[g];
+        for (int j = d->left[r], k = 0; k < 4; j = d->left[j], k++)
+            dlx_uncover(d, d->column[j]);
+    }
+
+    *result = (d->solutions > 0) ? SUDOKU_SOLVED : SUDOKU_NO_SOLUTUION;
+    //the count of a search that was stopped is not complete
+    if (d->cancel != NULL && atomic_load_explicit(d->cancel, memory_order_relaxed) && d->solutions < limit)
+        *result = SUDOKU_UNDECIDED;
+    *count = d->solutions;
+    *steps = d->steps;
+}
+
+/**
+ * This function solves the loaded sudoku, the search stops at the first solution
+ */
+void dlx_solve(Dlx *d, int *result, int *steps)
+{
+    int count;
+    dlx_count_solutions(d, 1, result, &count, steps);
+}
+
+/**
+ * This function writes the values of the sudoku in a buffer of 82 chars,
+ * if no buffer is provided one is allocated
+ */
+char *dlx_to_string_simple(Dlx *d, char *buff)
+{
+    //WARNING: This needs to be freed by someone but not us
+    if (buff == NULL)
+    {
+        buff = (char *)malloc((SUDOKU_CELLS + 1) * sizeof(char));
+    }
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        buff[i] = (char)(d->values[i] + '0');
+    }
+    buff[SUDOKU_CELLS] = '\0';
+
+    return buff;
+}
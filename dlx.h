@@ -0,0 +1,55 @@
+#if !defined(DLX_H)
+#define DLX_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "tables.h"
+
+//every cell must have a value and every row, column and box must have
+//every value once, that is 4 * 81 constraints
+#define DLX_COLUMNS 324
+//every value in every cell is a possible row of the matrix
+#define DLX_ROWS 729
+//the root, the column headers and 4 nodes for every row
+#define DLX_NODES (1 + DLX_COLUMNS + 4 * DLX_ROWS)
+
+/**
+ * The dancing links matrix of the sudoku exact cover problem. The links of the
+ * nodes are kept in separate arrays of indeces, node 0 is the root and nodes
+ * 1 to DLX_COLUMNS are the column headers. The matrix is built once, solving
+ * a sudoku covers and uncovers columns in place and leaves it as it found it
+ */
+typedef struct _Dlx
+{
+    uint16_t left[DLX_NODES];
+    uint16_t right[DLX_NODES];
+    uint16_t up[DLX_NODES];
+    uint16_t down[DLX_NODES];
+    //the column header of every node
+    uint16_t column[DLX_NODES];
+    //the matrix row of every node, the row is index * 9 + value - 1
+    uint16_t row[DLX_NODES];
+    //how many nodes every column has, indexed by the header
+    int size[1 + DLX_COLUMNS];
+
+    //the givens before solving and the solution after a successful solve
+    uint8_t values[SUDOKU_CELLS];
+    //the rows that have been chosen by the search
+    uint16_t chosen[SUDOKU_CELLS];
+    int steps;
+    //the solutions found so far and how many we look for
+    int solutions;
+    int limit;
+    //the search gives up once this is set, it can be NULL
+    atomic_int *cancel;
+} Dlx;
+
+Dlx *create_dlx();
+void dlx_free(Dlx *d);
+void dlx_load_from_char(Dlx *d, char *data);
+int dlx_get_empty_count(Dlx *d);
+void dlx_solve(Dlx *d, int *result, int *steps);
+void dlx_count_solutions(Dlx *d, int limit, int *result, int *count, int *steps);
+char *dlx_to_string_simple(Dlx *d, char *buff);
+
+#endif // DLX_H
@@ -0,0 +1,562 @@
+#include "engine.h"
+#include "sudoku.h"
+#include "bitboard.h"
+#include "batch.h"
+#include "dlx.h"
+#include "rate.h"
+#include "tree.h"
+#include "grid.h"
+#include <unistd.h>
+
+/**
+ * The registry of the solving engines. Every engine is a table of functions
+ * so the driver can solve, print and measure sudokus the same way no matter
+ * which engine is used. The built in engines are registered by
+ * engine_register_defaults, other engines can be registered next to them.
+ */
+
+static const SolverEngine *engines[ENGINE_CAPACITY];
+static int num_engines = 0;
+
+const char *ENGINE_PHASE_NAMES[ENGINE_PHASES] = {"parse", "setup", "propagate", "search", "teardown"};
+
+/**
+ * This function adds an engine to the registry. Returns false if there
+ * is no room left or an engine with the same name exists
+ */
+int engine_register(const SolverEngine *engine)
+{
+    if (num_engines == ENGINE_CAPACITY || engine_find(engine->name) != NULL)
+        return 0;
+
+    engines[num_engines++] = engine;
+    return 1;
+}
+
+/**
+ * This function returns the engine with a name, or NULL if there is none
+ */
+const SolverEngine *engine_find(const char *name)
+{
+    for (int i = 0; i < num_engines; i++)
+    {
+        if (strcmp(engines[i]->name, name) == 0)
+            return engines[i];
+    }
+    return NULL;
+}
+
+/**
+ * This function returns how many engines are registered
+ */
+int engine_get_count()
+{
+    return num_engines;
+}
+
+/**
+ * This function returns the i'th registered engine
+ */
+const SolverEngine *engine_get(int i)
+{
+    return engines[i];
+}
+
+#pragma region sudoku
+/**
+ * The engine of sudoku.c, with or without pencilmarks
+ */
+typedef struct _SudokuEngine
+{
+    Sudoku sudoku;
+    int with_pencilmarks;
+    int print_history;
+    int cell_rule;
+    int value_rule;
+    atomic_int *cancel;
+    EngineCounters counters;
+} SudokuEngine;
+
+static void *sudoku_engine_create(EngineOptions *options, int with_pencilmarks)
+{
+    SudokuEngine *e = (SudokuEngine *)aligned_alloc(SUDOKU_CACHE_LINE, sizeof(SudokuEngine));
+    sudoku_init(&e->sudoku);
+    e->with_pencilmarks = with_pencilmarks;
+    e->print_history = options->print_history;
+    e->cell_rule = options->cell_rule;
+    e->value_rule = options->value_rule;
+    e->cancel = options->cancel;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    return e;
+}
+
+static void *pencilmarks_engine_create(EngineOptions *options)
+{
+    return sudoku_engine_create(options, 1);
+}
+
+static void *backtracking_engine_create(EngineOptions *options)
+{
+    return sudoku_engine_create(options, 0);
+}
+
+static void sudoku_engine_free(void *state)
+{
+    free(state);
+}
+
+static void sudoku_engine_load_from_char(void *state, char *data)
+{
+    SudokuEngine *e = (SudokuEngine *)state;
+    int64_t *phase_ns = e->counters.phase_ns;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+
+    int64_t t0 = getTimeNs();
+    int data_int[SUDOKU_CELLS];
+    sudoku_string_to_int(data, data_int);
+
+    int64_t t1 = getTimeNs();
+    sudoku_init(&e->sudoku);
+    sudoku_setup_from_int(&e->sudoku, data_int, e->with_pencilmarks);
+    sudoku_set_print_history(&e->sudoku, e->print_history);
+    e->sudoku.cell_rule = e->cell_rule;
+    e->sudoku.value_rule = e->value_rule;
+    e->sudoku.cancel = e->cancel;
+
+    int64_t t2 = getTimeNs();
+    sudoku_prepare(&e->sudoku);
+
+    int64_t t3 = getTimeNs();
+    phase_ns[ENGINE_PHASE_PARSE] = t1 - t0;
+    phase_ns[ENGINE_PHASE_SETUP] = t2 - t1;
+    phase_ns[ENGINE_PHASE_PROPAGATE] = t3 - t2;
+}
+
+static void sudoku_engine_solve(void *state, int *result)
+{
+    SudokuEngine *e = (SudokuEngine *)state;
+    int64_t start = getTimeNs();
+    sudoku_solve(&e->sudoku, result, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void sudoku_engine_count_solutions(void *state, int limit, int *result, int *count)
+{
+    SudokuEngine *e = (SudokuEngine *)state;
+    int64_t start = getTimeNs();
+    sudoku_count_solutions(&e->sudoku, limit, result, count, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void sudoku_engine_get_values(void *state, uint8_t *values)
+{
+    memcpy(values, ((SudokuEngine *)state)->sudoku.values, SUDOKU_CELLS);
+}
+
+static void sudoku_engine_get_counters(void *state, EngineCounters *counters)
+{
+    SudokuEngine *e = (SudokuEngine *)state;
+    *counters = e->counters;
+#if defined(SUDOKU_STATS)
+    sudoku_get_stats(&e->sudoku, &counters->stats);
+#endif
+}
+
+static const SolverEngine pencilmarks_engine = {
+    "pencilmarks", "backtracking with pencilmarks, hidden singles and naked partners",
+    pencilmarks_engine_create, sudoku_engine_free, sudoku_engine_load_from_char,
+    sudoku_engine_solve, sudoku_engine_get_values, NULL, sudoku_engine_get_counters,
+    0, NULL, sudoku_engine_count_solutions};
+
+static const SolverEngine backtracking_engine = {
+    "backtracking", "plain backtracking without pencilmarks",
+    backtracking_engine_create, sudoku_engine_free, sudoku_engine_load_from_char,
+    sudoku_engine_solve, sudoku_engine_get_values, NULL, sudoku_engine_get_counters,
+    0, NULL, sudoku_engine_count_solutions};
+#pragma endregion
+
+#pragma region bitboard
+/**
+ * The engine of bitboard.c
+ */
+typedef struct _BitboardEngine
+{
+    Bitboard board;
+    atomic_int *cancel;
+    EngineCounters counters;
+} BitboardEngine;
+
+static void *bitboard_engine_create(EngineOptions *options)
+{
+    BitboardEngine *e = (BitboardEngine *)malloc(sizeof(BitboardEngine));
+    e->cancel = options->cancel;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    return e;
+}
+
+static void bitboard_engine_free(void *state)
+{
+    free(state);
+}
+
+static void bitboard_engine_load_from_char(void *state, char *data)
+{
+    BitboardEngine *e = (BitboardEngine *)state;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    int64_t start = getTimeNs();
+    bitboard_load_from_char(&e->board, data);
+    e->board.cancel = e->cancel;
+    e->counters.phase_ns[ENGINE_PHASE_PARSE] = getTimeNs() - start;
+}
+
+//placing the givens and propagating happen inside the search
+static void bitboard_engine_solve(void *state, int *result)
+{
+    BitboardEngine *e = (BitboardEngine *)state;
+    int64_t start = getTimeNs();
+    bitboard_solve(&e->board, result, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void bitboard_engine_count_solutions(void *state, int limit, int *result, int *count)
+{
+    BitboardEngine *e = (BitboardEngine *)state;
+    int64_t start = getTimeNs();
+    bitboard_count_solutions(&e->board, limit, result, count, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void bitboard_engine_get_values(void *state, uint8_t *values)
+{
+    memcpy(values, ((BitboardEngine *)state)->board.values, SUDOKU_CELLS);
+}
+
+static void bitboard_engine_get_counters(void *state, EngineCounters *counters)
+{
+    *counters = ((BitboardEngine *)state)->counters;
+}
+
+/**
+ * The vector kernel of batch.c, the sudokus it can't decide
+ * go to the bitboard engine
+ */
+static void simd_engine_solve_batch(char **sudokus, int num_sudokus, int *results, uint8_t (*values)[SUDOKU_CELLS])
+{
+    SudokuBatch sb;
+    batch_load_from_char(&sb, sudokus, num_sudokus);
+    batch_propagate(&sb, results);
+    for (int lane = 0; lane < num_sudokus; lane++)
+    {
+        batch_get_values(&sb, lane, values[lane]);
+    }
+}
+
+static const SolverEngine bitboard_engine = {
+    "bitboard", "per digit bitboards with whole board singles propagation",
+    bitboard_engine_create, bitboard_engine_free, bitboard_engine_load_from_char,
+    bitboard_engine_solve, bitboard_engine_get_values, NULL, bitboard_engine_get_counters,
+    0, NULL, bitboard_engine_count_solutions};
+
+static const SolverEngine simd_engine = {
+    "simd", "singles propagation for 16 sudokus in lockstep, bitboard for the rest",
+    bitboard_engine_create, bitboard_engine_free, bitboard_engine_load_from_char,
+    bitboard_engine_solve, bitboard_engine_get_values, NULL, bitboard_engine_get_counters,
+    BATCH_LANES, simd_engine_solve_batch, bitboard_engine_count_solutions};
+#pragma endregion
+
+#pragma region parallel
+/**
+ * The engine of tree.c, the bitboard search of a single sudoku split
+ * between a team of threads that the engine creates
+ */
+typedef struct _ParallelEngine
+{
+    Bitboard board;
+    TreeSearch *search;
+    EngineCounters counters;
+} ParallelEngine;
+
+static void *parallel_engine_create(EngineOptions *options)
+{
+    ParallelEngine *e = (ParallelEngine *)malloc(sizeof(ParallelEngine));
+    //without a number of threads the search uses every processor
+    int num_threads = options->search_threads;
+    if (num_threads <= 0)
+        num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    e->search = create_tree_search(num_threads, options->cancel);
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    return e;
+}
+
+static void parallel_engine_free(void *state)
+{
+    ParallelEngine *e = (ParallelEngine *)state;
+    tree_search_free(e->search);
+    free(e);
+}
+
+static void parallel_engine_load_from_char(void *state, char *data)
+{
+    ParallelEngine *e = (ParallelEngine *)state;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    int64_t start = getTimeNs();
+    bitboard_load_from_char(&e->board, data);
+    e->counters.phase_ns[ENGINE_PHASE_PARSE] = getTimeNs() - start;
+}
+
+static void parallel_engine_count_solutions(void *state, int limit, int *result, int *count)
+{
+    ParallelEngine *e = (ParallelEngine *)state;
+    int64_t start = getTimeNs();
+    tree_search_count(e->search, &e->board, limit, result, count, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void parallel_engine_solve(void *state, int *result)
+{
+    int count;
+    parallel_engine_count_solutions(state, 1, result, &count);
+}
+
+static void parallel_engine_get_values(void *state, uint8_t *values)
+{
+    memcpy(values, ((ParallelEngine *)state)->board.values, SUDOKU_CELLS);
+}
+
+static void parallel_engine_get_counters(void *state, EngineCounters *counters)
+{
+    *counters = ((ParallelEngine *)state)->counters;
+}
+
+static const SolverEngine parallel_engine = {
+    "parallel", "the bitboard search of every sudoku split between threads that steal subtrees",
+    parallel_engine_create, parallel_engine_free, parallel_engine_load_from_char,
+    parallel_engine_solve, parallel_engine_get_values, NULL, parallel_engine_get_counters,
+    0, NULL, parallel_engine_count_solutions};
+#pragma endregion
+
+#pragma region grid
+/**
+ * The engine of grid.c with the kernel of order 3, so the kernels of every
+ * order can be compared to the other engines on the classic sudokus
+ */
+typedef struct _GridEngine
+{
+    Grid grid;
+    atomic_int *cancel;
+    EngineCounters counters;
+} GridEngine;
+
+static void *grid_engine_create(EngineOptions *options)
+{
+    GridEngine *e = (GridEngine *)malloc(sizeof(GridEngine));
+    e->cancel = options->cancel;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    return e;
+}
+
+static void grid_engine_free(void *state)
+{
+    free(state);
+}
+
+static void grid_engine_load_from_char(void *state, char *data)
+{
+    GridEngine *e = (GridEngine *)state;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    int64_t start = getTimeNs();
+    //every char that is not a digit is an empty cell, like the other engines
+    char givens[SUDOKU_CELLS];
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        givens[i] = (data[i] >= '1' && data[i] <= '9') ? data[i] : '0';
+    }
+    grid_load_from_char(&e->grid, 3, givens);
+    e->grid.cancel = e->cancel;
+    e->counters.phase_ns[ENGINE_PHASE_PARSE] = getTimeNs() - start;
+}
+
+static void grid_engine_count_solutions(void *state, int limit, int *result, int *count)
+{
+    GridEngine *e = (GridEngine *)state;
+    int64_t start = getTimeNs();
+    grid_count_solutions(&e->grid, limit, result, count, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void grid_engine_solve(void *state, int *result)
+{
+    int count;
+    grid_engine_count_solutions(state, 1, result, &count);
+}
+
+static void grid_engine_get_values(void *state, uint8_t *values)
+{
+    memcpy(values, ((GridEngine *)state)->grid.values, SUDOKU_CELLS);
+}
+
+static void grid_engine_get_counters(void *state, EngineCounters *counters)
+{
+    *counters = ((GridEngine *)state)->counters;
+}
+
+static const SolverEngine grid_engine = {
+    "grid", "the kernel of grid.c for any box order, specialized for 9x9 with 16 bit masks",
+    grid_engine_create, grid_engine_free, grid_engine_load_from_char,
+    grid_engine_solve, grid_engine_get_values, NULL, grid_engine_get_counters,
+    0, NULL, grid_engine_count_solutions};
+#pragma endregion
+
+#pragma region dlx
+/**
+ * The engine of dlx.c, the matrix is built once when the engine is created
+ */
+typedef struct _DlxEngine
+{
+    Dlx *dlx;
+    EngineCounters counters;
+} DlxEngine;
+
+static void *dlx_engine_create(EngineOptions *options)
+{
+    DlxEngine *e = (DlxEngine *)malloc(sizeof(DlxEngine));
+    e->dlx = create_dlx();
+    e->dlx->cancel = options->cancel;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    return e;
+}
+
+static void dlx_engine_free(void *state)
+{
+    DlxEngine *e = (DlxEngine *)state;
+    dlx_free(e->dlx);
+    free(e);
+}
+
+static void dlx_engine_load_from_char(void *state, char *data)
+{
+    DlxEngine *e = (DlxEngine *)state;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    int64_t start = getTimeNs();
+    dlx_load_from_char(e->dlx, data);
+    e->counters.phase_ns[ENGINE_PHASE_PARSE] = getTimeNs() - start;
+}
+
+//choosing the givens happens inside the search
+static void dlx_engine_solve(void *state, int *result)
+{
+    DlxEngine *e = (DlxEngine *)state;
+    int64_t start = getTimeNs();
+    dlx_solve(e->dlx, result, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void dlx_engine_count_solutions(void *state, int limit, int *result, int *count)
+{
+    DlxEngine *e = (DlxEngine *)state;
+    int64_t start = getTimeNs();
+    dlx_count_solutions(e->dlx, limit, result, count, &e->counters.steps);
+    e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - start;
+}
+
+static void dlx_engine_get_values(void *state, uint8_t *values)
+{
+    memcpy(values, ((DlxEngine *)state)->dlx->values, SUDOKU_CELLS);
+}
+
+static void dlx_engine_get_counters(void *state, EngineCounters *counters)
+{
+    *counters = ((DlxEngine *)state)->counters;
+}
+
+static const SolverEngine dlx_engine = {
+    "dlx", "dancing links on the exact cover matrix",
+    dlx_engine_create, dlx_engine_free, dlx_engine_load_from_char,
+    dlx_engine_solve, dlx_engine_get_values, NULL, dlx_engine_get_counters,
+    0, NULL, dlx_engine_count_solutions};
+#pragma endregion
+
+#pragma region rating
+/**
+ * The engine of rate.c. Its steps are the score of the sudoku, so the
+ * logs and the difficulty range of the generator work on the rating
+ */
+typedef struct _RatingEngine
+{
+    Rating rating;
+    EngineCounters counters;
+} RatingEngine;
+
+static void *rating_engine_create(EngineOptions *options)
+{
+    //the rating doesn't search, so none of the options apply
+    (void)options;
+    RatingEngine *e = (RatingEngine *)malloc(sizeof(RatingEngine));
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    return e;
+}
+
+static void rating_engine_free(void *state)
+{
+    free(state);
+}
+
+//the candidates are set up while the givens are read
+static void rating_engine_load_from_char(void *state, char *data)
+{
+    RatingEngine *e = (RatingEngine *)state;
+    memset(&e->counters, 0, sizeof(EngineCounters));
+    int64_t start = getTimeNs();
+    rate_load_from_char(&e->rating, data);
+    e->counters.phase_ns[ENGINE_PHASE_SETUP] = getTimeNs() - start;
+}
+
+static void rating_engine_solve(void *state, int *result)
+{
+    RatingEngine *e = (RatingEngine *)state;
+    int64_t start = getTimeNs();
+    *result = rate_logic(&e->rating);
+    int64_t end = getTimeNs();
+    e->counters.phase_ns[ENGINE_PHASE_PROPAGATE] = end - start;
+
+    //the techniques were not enough
+    if (*result == SUDOKU_UNDECIDED)
+    {
+        *result = rate_search(&e->rating);
+        e->counters.phase_ns[ENGINE_PHASE_SEARCH] = getTimeNs() - end;
+    }
+    e->counters.steps = e->rating.score;
+}
+
+static void rating_engine_get_values(void *state, uint8_t *values)
+{
+    memcpy(values, ((RatingEngine *)state)->rating.values, SUDOKU_CELLS);
+}
+
+static void rating_engine_get_counters(void *state, EngineCounters *counters)
+{
+    *counters = ((RatingEngine *)state)->counters;
+}
+
+static const SolverEngine rating_engine = {
+    "rating", "logic techniques from the cheapest up, the steps are the score in tenths",
+    rating_engine_create, rating_engine_free, rating_engine_load_from_char,
+    rating_engine_solve, rating_engine_get_values, NULL, rating_engine_get_counters,
+    0, NULL, NULL};
+#pragma endregion
+
+/**
+ * This function registers the engines that come with the solver,
+ * the first one is the default
+ */
+void engine_register_defaults()
+{
+    engine_register(&pencilmarks_engine);
+    engine_register(&backtracking_engine);
+    engine_register(&bitboard_engine);
+    engine_register(&simd_engine);
+    engine_register(&parallel_engine);
+    engine_register(&grid_engine);
+    engine_register(&dlx_engine);
+    engine_register(&rating_engine);
+}
@@ -0,0 +1,104 @@
+#if !defined(ENGINE_H)
+#define ENGINE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "tables.h"
+#include "sudoku.h"
+
+//how many engines can be registered
+#define ENGINE_CAPACITY 16
+
+/**
+ * The options an engine is created with
+ */
+typedef struct _EngineOptions
+{
+    //whether the steps of every solution are written to the history directory
+    int print_history;
+    //the SUDOKU_CELL_* and SUDOKU_VALUE_* rules of the engines built on sudoku.c
+    int cell_rule;
+    int value_rule;
+    //when another thread sets it the search gives up and the result is
+    //SUDOKU_UNDECIDED, NULL if nobody stops the engine
+    atomic_int *cancel;
+    //how many threads the engines that split a single search use, 0 for
+    //one for every processor
+    int search_threads;
+} EngineOptions;
+
+/**
+ * The phases of solving a sudoku. An engine that doesn't separate two
+ * phases reports their time in the later one
+ */
+typedef enum _EnginePhase
+{
+    //converting the string
+    ENGINE_PHASE_PARSE,
+    //filling in the givens and the bookkeeping that follows from them
+    ENGINE_PHASE_SETUP,
+    //the deductions that are made before the first guess
+    ENGINE_PHASE_PROPAGATE,
+    //guessing and backtracking
+    ENGINE_PHASE_SEARCH,
+    //releasing what the sudoku used
+    ENGINE_PHASE_TEARDOWN,
+    ENGINE_PHASES
+} EnginePhase;
+
+extern const char *ENGINE_PHASE_NAMES[ENGINE_PHASES];
+
+/**
+ * What an engine reports about the last sudoku it solved
+ */
+typedef struct _EngineCounters
+{
+    int steps;
+    //the nanoseconds spent in every phase
+    int64_t phase_ns[ENGINE_PHASES];
+#if defined(SUDOKU_STATS)
+    //the work of every technique, only engines built on sudoku.c fill it in
+    SudokuStats stats;
+#endif
+} EngineCounters;
+
+/**
+ * A solving engine. The state of an engine is created once for every thread
+ * that uses it and holds one sudoku at a time, so solving needs no allocation
+ */
+typedef struct _SolverEngine
+{
+    const char *name;
+    const char *description;
+
+    void *(*create)(EngineOptions *options);
+    void (*free)(void *state);
+    //load a sudoku string of SUDOKU_STRING_LENGTH chars, it doesn't need to be null terminated
+    void (*load_from_char)(void *state, char *data);
+    //solve the loaded sudoku and write one of the SUDOKU_* result codes
+    void (*solve)(void *state, int *result);
+    //write the value of every cell, 0 for the empty ones
+    void (*get_values)(void *state, uint8_t *values);
+    //release what the loaded sudoku uses, the values and counters stay available
+    void (*release)(void *state);
+    void (*get_counters)(void *state, EngineCounters *counters);
+
+    //optionally, a kernel that solves up to batch_lanes sudokus at once. It writes
+    //the result and the values of every sudoku, the sudokus that are left
+    //SUDOKU_UNDECIDED are solved one by one with the functions above
+    int batch_lanes;
+    void (*solve_batch)(char **sudokus, int num_sudokus, int *results, uint8_t (*values)[SUDOKU_CELLS]);
+
+    //optionally, count the solutions of the loaded sudoku up until there are limit
+    //of them, the search goes on after a solution in the same state. It is used
+    //instead of solve and leaves the values of the first solution
+    void (*count_solutions)(void *state, int limit, int *result, int *count);
+} SolverEngine;
+
+int engine_register(const SolverEngine *engine);
+void engine_register_defaults();
+const SolverEngine *engine_find(const char *name);
+int engine_get_count();
+const SolverEngine *engine_get(int i);
+
+#endif // ENGINE_H
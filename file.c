@@ -1,95 +1,155 @@
 #include "file.h"
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /**
- * This function puts sudoku strings to a string array.
- * It receives a filename and a string array as arguments.
- * This function should be called on files with a specific 
- * format
+ * This function reads the whole contents of a file that can not be mapped
+ * in memory to a buffer. It returns the buffer and writes its size in size
  */
-char **get_sudokus_from_file(char *fname, char **buff, int buff_len)
+static char *read_whole_file(int fd, size_t *size)
+{
+    size_t capacity = 1 << 16;
+    size_t used = 0;
+    char *buff = (char *)malloc(capacity);
+
+    ssize_t n;
+    while ((n = read(fd, buff + used, capacity - used)) > 0)
+    {
+        used += n;
+        //if the buffer is full double its size
+        if (used == capacity)
+        {
+            capacity *= 2;
+            buff = (char *)realloc(buff, capacity);
+        }
+    }
+
+    *size = used;
+    return buff;
+}
+
+/**
+ * This function finds the expected solution in a line that holds a sudoku.
+ * The solution is the column of SUDOKU_STRING_LENGTH chars that follows the
+ * sudoku after a separator (a comma or whitespace), e.g. "puzzle,solution".
+ * Returns NULL if the line has no solution
+ */
+char *sudoku_line_find_solution(char *line, char *line_end)
+{
+    char *solution = line + SUDOKU_STRING_LENGTH + 1;
+    if (line_end - solution < SUDOKU_STRING_LENGTH)
+        return NULL;
+
+    char separator = line[SUDOKU_STRING_LENGTH];
+    if (separator != ',' && separator != ' ' && separator != '\t')
+        return NULL;
+
+    return solution;
+}
+
+/**
+ * This function loads the sudokus of a file. The file should have one sudoku
+ * per line, it can be followed by its expected solution (see
+ * sudoku_line_find_solution), anything else on a line is ignored and so are
+ * the lines that are too short to hold a sudoku.
+ * At most max_sudokus sudokus are loaded.
+ *
+ * The file is mapped in memory and the line boundaries are found in a single
+ * pass with memchr, the sudoku strings point directly in the mapping so
+ * nothing is copied. Returns NULL if the file can not be opened
+ */
+SudokuFile *sudoku_file_open(char *filename, int max_sudokus)
 {
     //try to open the file
-    FILE *sudoku_file = fopen(fname, "r");
-    //if the file can be opend
-    if (sudoku_file != NULL)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    SudokuFile *f = (SudokuFile *)malloc(sizeof(SudokuFile));
+    f->data = NULL;
+    f->size = 0;
+    f->mapped = 0;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
     {
-        //count in which line we are
-        int counter = 0;
-        //the character we are about to read
-        char c;
-        //so long as we can read more files
-        while ((c = fgetc(sudoku_file)) != EOF)
+        f->size = st.st_size;
+        //an empty file can not be mapped, but it has no sudokus anyway
+        if (f->size > 0)
         {
-            //if we read a comma that means we have read the entire sudoki
-            //and now we are about to read the solution
-            //for now we don't care about it so we read characters until
-            //we get to the next line
-            if (c == ',')
+            void *data = mmap(NULL, f->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
             {
-                while (1)
-                {
-                    //read characters
-                    c = fgetc(sudoku_file);
-                    //up until a newline is read
-                    if (c == '\n')
-                        break;
-                }
+                f->data = (char *)data;
+                f->mapped = 1;
+                //we read the file once from start to end
+                madvise(data, f->size, MADV_SEQUENTIAL);
             }
-            //if a newline is read
-            if (c == '\n')
-                //increament the counter so that the next sudoku string
-                //goes to the next array position
-                counter++;
+        }
+    }
+    //if the file couldn't be mapped read it in a buffer instead
+    if (!f->mapped)
+    {
+        f->data = read_whole_file(fd, &f->size);
+    }
+    close(fd);
+
+    //a line holds at least a sudoku and a newline, so this is
+    //a good first guess of the number of sudokus
+    int capacity = f->size / (SUDOKU_STRING_LENGTH + 1) + 1;
+    if (capacity > max_sudokus)
+        capacity = max_sudokus;
+    f->sudokus = (char **)malloc(capacity * sizeof(char *));
+    f->solutions = (char **)malloc(capacity * sizeof(char *));
+    f->num_sudokus = 0;
+
+    char *line = f->data;
+    char *end = f->data + f->size;
+    //so long as there are lines to read and we need more sudokus
+    while (line < end && f->num_sudokus < max_sudokus)
+    {
+        //find where the line ends
+        char *newline = (char *)memchr(line, '\n', end - line);
+        char *line_end = newline ? newline : end;
 
-            else //if we read a number
+        //only lines that are long enough hold a sudoku
+        if (line_end - line >= SUDOKU_STRING_LENGTH)
+        {
+            if (f->num_sudokus == capacity)
             {
-                //allocate memory for a single number string
-                char str[2] = "\0";
-                str[0] = c;
-                //and concatinate it to the string at that position in the array
-                strcat(buff[counter], str);
+                capacity *= 2;
+                f->sudokus = (char **)realloc(f->sudokus, capacity * sizeof(char *));
+                f->solutions = (char **)realloc(f->solutions, capacity * sizeof(char *));
             }
-            //if we have filled the buffer then break out of the reading loop
-            if (counter == buff_len)
-                break;
+            f->solutions[f->num_sudokus] = sudoku_line_find_solution(line, line_end);
+            f->sudokus[f->num_sudokus++] = line;
         }
-        //close the file
-        fclose(sudoku_file);
+
+        //continue after the newline
+        line = line_end + 1;
     }
 
-    //and return the string array
-    return buff;
+    return f;
 }
 
 /**
- * This function returns the number of lines in a 
- * file, by counting how many newlines there are in the file
+ * This function unmaps the file and frees everything that was used by it.
+ * The sudoku strings can not be used after this
  */
-int get_number_of_lines_in_file(char *filename)
+void sudoku_file_close(SudokuFile *f)
 {
-    //assume the file doesn't exist
-    //a non existent file doesn't have any lines in it
-    int lines = 0;
-
-    //attempt to open the file
-    FILE *fp = fopen(filename, "r");
-    //if we succeed
-    if (fp != NULL)
+    if (f->mapped)
     {
-        // printf("%s\n", "hi");
-        //if a file exists then it has at least one line
-        lines = 1;
-        char c;
-        //keep reading characters
-        while ((c = fgetc(fp)) != EOF)
-        {
-            //for every newline we see increament the lines of the file
-            lines += (c == '\n');
-        }
-        //close the file
-        fclose(fp);
+        munmap(f->data, f->size);
     }
-
-    //return the number of lines
-    return lines;
+    else
+    {
+        free(f->data);
+    }
+    free(f->sudokus);
+    free(f->solutions);
+    free(f);
 }
@@ -1,11 +1,32 @@
-
 #if !defined(FILE_H)
 #define FILE_H
 
 #include <stdio.h>
 #include <string.h>
-char **get_sudokus_from_file(char *fname, char **buff, int buff_len);
-char *get_sudoku_by_index(char *sudokus, char *buff, int index);
-int get_number_of_lines_in_file(char *filename);
+
+//how many characters a sudoku string has
+#define SUDOKU_STRING_LENGTH 81
+
+/**
+ * The sudokus of a file. The file is mapped in memory and every sudoku
+ * string points directly in the mapping, the strings are not null terminated
+ */
+typedef struct _SudokuFile
+{
+    //the contents of the file
+    char *data;
+    size_t size;
+    //whether data is a mapping of the file or a buffer we allocated
+    int mapped;
+
+    int num_sudokus;
+    char **sudokus;
+    //the expected solution of every sudoku, NULL if its line has none
+    char **solutions;
+} SudokuFile;
+
+SudokuFile *sudoku_file_open(char *filename, int max_sudokus);
+char *sudoku_line_find_solution(char *line, char *line_end);
+void sudoku_file_close(SudokuFile *f);
 
 #endif // FILE_H
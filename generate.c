@@ -0,0 +1,210 @@
+#include "generate.h"
+#include "sudoku.h"
+
+/**
+ * A generator of sudokus. A random complete grid is made by filling the three
+ * boxes on the diagonal with random permutations, they don't share a row or a
+ * column so any permutations fit, and letting the bitboard engine fill in
+ * the rest. Then the clues are removed in a random order, a clue stays removed
+ * only if the sudoku still has a single solution, so the result has a unique
+ * solution and no clue can be removed from it.
+ *
+ * Removing clues only makes a sudoku harder, so if the rating engine needs
+ * more steps than the range allows, clues of the solution are given back until
+ * it doesn't. A sudoku that ends up easier than the range is thrown away.
+ */
+
+/**
+ * This function returns the next random number (splitmix64)
+ */
+static uint64_t generator_random(Generator *g)
+{
+    uint64_t z = (g->rng += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * This function puts the elements of an array in a random order (Fisher-Yates)
+ */
+static void generator_shuffle(Generator *g, uint8_t *data, int len)
+{
+    for (int i = len - 1; i > 0; i--)
+    {
+        int j = (int)(generator_random(g) % (i + 1));
+        uint8_t tmp = data[i];
+        data[i] = data[j];
+        data[j] = tmp;
+    }
+}
+
+/**
+ * This function creates a generator. The seed picks the sudokus it makes, the
+ * engine rates them and only the ones that need between min_steps and
+ * max_steps steps are kept
+ */
+Generator *create_generator(uint64_t seed, const SolverEngine *engine, int min_steps, int max_steps)
+{
+    Generator *g = (Generator *)malloc(sizeof(Generator));
+    g->rng = seed;
+
+    EngineOptions options = {0};
+    g->engine = engine;
+    g->engine_state = engine->create(&options);
+
+    g->min_steps = min_steps;
+    g->max_steps = max_steps;
+    g->candidates = 0;
+    g->generated = 0;
+    return g;
+}
+
+/**
+ * This function frees a generator and everything it uses
+ */
+void generator_free(Generator *g)
+{
+    g->engine->free(g->engine_state);
+    free(g);
+}
+
+/**
+ * This function makes the generator start over from a seed. The sudokus
+ * only depend on the seed, so seeding before every sudoku makes the same
+ * sudokus no matter which thread makes them
+ */
+void generator_seed(Generator *g, uint64_t seed)
+{
+    g->rng = seed;
+}
+
+/**
+ * This function writes a random complete grid as a sudoku string
+ */
+static void generator_fill_grid(Generator *g, char *grid)
+{
+    memset(grid, '0', SUDOKU_CELLS);
+
+    //the boxes on the diagonal are independent
+    for (int b = 0; b < 9; b += 4)
+    {
+        uint8_t digits[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        generator_shuffle(g, digits, 9);
+        for (int i = 0; i < 9; i++)
+        {
+            grid[BOXES[b][i]] = (char)('0' + digits[i]);
+        }
+    }
+
+    //any such grid can be completed
+    int result, steps;
+    bitboard_load_from_char(&g->board, grid);
+    bitboard_solve(&g->board, &result, &steps);
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        grid[i] = (char)('0' + g->board.values[i]);
+    }
+}
+
+/**
+ * This function returns true if a sudoku string has a single solution
+ */
+static int generator_is_unique(Generator *g, char *sudoku)
+{
+    int result, count, steps;
+    bitboard_load_from_char(&g->board, sudoku);
+    bitboard_count_solutions(&g->board, 2, &result, &count, &steps);
+    return count == 1;
+}
+
+/**
+ * This function returns true if the clues of the peers of an empty cell leave
+ * it a single value. Then removing the clue of the cell from a sudoku that has
+ * a unique solution keeps the solution unique, without searching
+ */
+static int generator_is_forced(char *sudoku, int index)
+{
+    int used = 0;
+    for (int i = 0; i < SUDOKU_NEIGHBORS; i++)
+    {
+        used |= 1 << (sudoku[NEIGHBORS[index][i]] - '0');
+    }
+    //the bit of the empty cells doesn't count
+    return count_ones(used & ALL_PENCILMARKS) == 8;
+}
+
+/**
+ * This function returns the steps the rating engine needs to solve a sudoku
+ */
+static int generator_rate(Generator *g, char *sudoku)
+{
+    int result;
+    EngineCounters counters;
+
+    g->engine->load_from_char(g->engine_state, sudoku);
+    g->engine->solve(g->engine_state, &result);
+    if (g->engine->release != NULL)
+        g->engine->release(g->engine_state);
+    g->engine->get_counters(g->engine_state, &counters);
+
+    return counters.steps;
+}
+
+/**
+ * This function makes a sudoku with a unique solution in the range of steps of
+ * the generator and writes it as a string of SUDOKU_CELLS chars followed by a
+ * null terminator. Returns the steps the rating engine needs to solve it,
+ * or -1 if GENERATOR_MAX_CANDIDATES sudokus in a row were out of the range
+ */
+int generator_next(Generator *g, char *sudoku)
+{
+    char grid[SUDOKU_CELLS];
+
+    for (int attempt = 0; attempt < GENERATOR_MAX_CANDIDATES; attempt++)
+    {
+        g->candidates++;
+        generator_fill_grid(g, grid);
+        memcpy(sudoku, grid, SUDOKU_CELLS);
+        sudoku[SUDOKU_CELLS] = '\0';
+
+        //try to remove every clue, in a random order
+        uint8_t order[SUDOKU_CELLS];
+        for (int i = 0; i < SUDOKU_CELLS; i++)
+        {
+            order[i] = (uint8_t)i;
+        }
+        generator_shuffle(g, order, SUDOKU_CELLS);
+
+        //the clues that were removed, in the order they were removed in
+        uint8_t removed[SUDOKU_CELLS];
+        int num_removed = 0;
+        for (int i = 0; i < SUDOKU_CELLS; i++)
+        {
+            int cell = order[i];
+            sudoku[cell] = '0';
+            if (generator_is_forced(sudoku, cell) || generator_is_unique(g, sudoku))
+                removed[num_removed++] = (uint8_t)cell;
+            else
+                sudoku[cell] = grid[cell];
+        }
+
+        //give clues back, the last ones that were removed first, until
+        //the sudoku is not too hard, it stays unique
+        int steps = generator_rate(g, sudoku);
+        while (steps > g->max_steps && num_removed > 0)
+        {
+            int cell = removed[--num_removed];
+            sudoku[cell] = grid[cell];
+            steps = generator_rate(g, sudoku);
+        }
+
+        if (steps >= g->min_steps && steps <= g->max_steps)
+        {
+            g->generated++;
+            return steps;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,40 @@
+#if !defined(GENERATE_H)
+#define GENERATE_H
+
+#include <stdint.h>
+#include "tables.h"
+#include "bitboard.h"
+#include "engine.h"
+
+//how many sudokus in a row can be thrown away before we give up on the range
+#define GENERATOR_MAX_CANDIDATES 100000
+
+/**
+ * A generator of sudokus with a unique solution. It is created once for every
+ * thread that generates sudokus, so generating needs no allocation. The
+ * difficulty of a sudoku is the steps the rating engine needs to solve it
+ */
+typedef struct _Generator
+{
+    //the state of the random numbers
+    uint64_t rng;
+    //completes the grids and checks that the solution is unique while
+    //clues are removed, it is the fastest engine that can count solutions
+    Bitboard board;
+    //rates the difficulty of the sudokus
+    const SolverEngine *engine;
+    void *engine_state;
+    //the range of steps a sudoku needs to be in, inclusive
+    int min_steps;
+    int max_steps;
+    //how many sudokus were made and how many of them were in the range
+    long candidates;
+    long generated;
+} Generator;
+
+Generator *create_generator(uint64_t seed, const SolverEngine *engine, int min_steps, int max_steps);
+void generator_free(Generator *g);
+void generator_seed(Generator *g, uint64_t seed);
+int generator_next(Generator *g, char *sudoku);
+
+#endif // GENERATE_H
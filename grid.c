@@ -0,0 +1,229 @@
+#include "grid.h"
+#include "sudoku.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Sudokus of any box order, from 4x4 to 25x25. The rest of the solver is
+ * written for the classic 9x9 sudoku, its tables and masks are sized for it
+ * and it stays that way so that it is not slowed down. These kernels are
+ * generated from grid_kernel.h once for every order, each with the narrowest
+ * candidate mask that fits its values, and the functions below pick the one
+ * of the order of the grid.
+ */
+
+#define GRID_ORDER 2
+#define GRID_MASK uint8_t
+#include "grid_kernel.h"
+#undef GRID_MASK
+#undef GRID_ORDER
+
+#define GRID_ORDER 3
+#define GRID_MASK uint16_t
+#include "grid_kernel.h"
+#undef GRID_MASK
+#undef GRID_ORDER
+
+#define GRID_ORDER 4
+#define GRID_MASK uint16_t
+#include "grid_kernel.h"
+#undef GRID_MASK
+#undef GRID_ORDER
+
+#define GRID_ORDER 5
+#define GRID_MASK uint32_t
+#include "grid_kernel.h"
+#undef GRID_MASK
+#undef GRID_ORDER
+
+/**
+ * This function returns the value of a char, 0 for an empty cell and
+ * -1 for a char that is neither a value nor an empty cell
+ */
+static int grid_char_value(char c)
+{
+    if (c == '0' || c == '.')
+        return 0;
+    if (c >= '1' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * This function returns the char of a value
+ */
+static char grid_value_char(int value)
+{
+    if (value == 0)
+        return '0';
+    return (char)((value <= 9) ? '0' + value : 'A' + value - 10);
+}
+
+/**
+ * This function returns the order of the grids that have length cells, or 0
+ * if there are none
+ */
+int grid_order_from_length(int length)
+{
+    for (int order = GRID_MIN_ORDER; order <= GRID_MAX_ORDER; order++)
+    {
+        if (order * order * order * order == length)
+            return order;
+    }
+    return 0;
+}
+
+/**
+ * This function loads a grid of an order from a string of order^4 chars.
+ * Values go from 1 to 9 and then from A, 0 and . are empty cells. Returns
+ * false if a char is not a value of the order
+ */
+int grid_load_from_char(Grid *g, int order, const char *data)
+{
+    g->order = order;
+    g->size = order * order;
+    g->cells = g->size * g->size;
+    g->steps = 0;
+    g->solutions = 0;
+    g->limit = 0;
+    g->cancel = NULL;
+
+    for (int i = 0; i < g->cells; i++)
+    {
+        int value = grid_char_value(data[i]);
+        if (value < 0 || value > g->size)
+            return 0;
+        g->values[i] = (uint8_t)value;
+    }
+    return 1;
+}
+
+/**
+ * This function returns the index of the first of the order^4 chars of data
+ * that is neither a value of the order nor an empty cell, or -1 if there is
+ * none
+ */
+int grid_find_invalid_char(int order, const char *data)
+{
+    int size = order * order;
+    for (int i = 0; i < size * size; i++)
+    {
+        int value = grid_char_value(data[i]);
+        if (value < 0 || value > size)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * This function returns how many cells of the grid are empty
+ */
+int grid_get_empty_count(Grid *g)
+{
+    int count = 0;
+    for (int i = 0; i < g->cells; i++)
+    {
+        count += g->values[i] == 0;
+    }
+    return count;
+}
+
+/**
+ * This function counts the solutions of a grid up until there are limit of
+ * them, the values become the first solution that was found
+ */
+void grid_count_solutions(Grid *g, int limit, int *result, int *count, int *steps)
+{
+    g->steps = 0;
+    g->solutions = 0;
+    g->limit = limit;
+
+    switch (g->order)
+    {
+    case 2:
+        grid_run_o2(g);
+        break;
+    case 3:
+        grid_run_o3(g);
+        break;
+    case 4:
+        grid_run_o4(g);
+        break;
+    case 5:
+        grid_run_o5(g);
+        break;
+    }
+
+    if (g->solutions > 0)
+        memcpy(g->values, g->first, g->cells);
+
+    *result = (g->solutions > 0) ? SUDOKU_SOLVED : SUDOKU_NO_SOLUTUION;
+    //the count of a search that was stopped is not complete
+    if (g->cancel != NULL && atomic_load_explicit(g->cancel, memory_order_relaxed) && g->solutions < limit)
+        *result = SUDOKU_UNDECIDED;
+    *count = g->solutions;
+    *steps = g->steps;
+}
+
+/**
+ * This function solves a grid, the search stops at the first solution
+ */
+void grid_solve(Grid *g, int *result, int *steps)
+{
+    int count;
+    grid_count_solutions(g, 1, result, &count, steps);
+}
+
+/**
+ * This function checks that the values of a grid are a solution of the grid
+ * string it was loaded from: every given is kept and every house has every
+ * value once. Returns false if they are not
+ */
+int grid_verify(Grid *g, const char *data)
+{
+    int n = g->size;
+    for (int i = 0; i < g->cells; i++)
+    {
+        int given = grid_char_value(data[i]);
+        if (g->values[i] == 0 || (given != 0 && given != g->values[i]))
+            return 0;
+    }
+
+    for (int h = 0; h < n; h++)
+    {
+        uint32_t rows = 0, cols = 0, boxes = 0;
+        int box_row = (h / g->order) * g->order;
+        int box_col = (h % g->order) * g->order;
+        for (int k = 0; k < n; k++)
+        {
+            rows |= 1u << (g->values[h * n + k] - 1);
+            cols |= 1u << (g->values[k * n + h] - 1);
+            boxes |= 1u << (g->values[(box_row + k / g->order) * n + box_col + k % g->order] - 1);
+        }
+        uint32_t full = (1u << n) - 1;
+        if (rows != full || cols != full || boxes != full)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * This function writes the values of the grid in a buffer of cells + 1 chars,
+ * if no buffer is provided one is allocated
+ */
+char *grid_to_string_simple(Grid *g, char *buff)
+{
+    //WARNING: This needs to be freed by someone but not us
+    if (buff == NULL)
+        buff = (char *)malloc(g->cells + 1);
+    for (int i = 0; i < g->cells; i++)
+    {
+        buff[i] = grid_value_char(g->values[i]);
+    }
+    buff[g->cells] = '\0';
+    return buff;
+}
@@ -0,0 +1,45 @@
+#if !defined(GRID_H)
+#define GRID_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+//the box orders there are kernels for, the grid of order n has n^2 x n^2
+//cells, from 4x4 up to 25x25. Order 3 is the classic sudoku
+#define GRID_MIN_ORDER 2
+#define GRID_MAX_ORDER 5
+#define GRID_MAX_SIZE (GRID_MAX_ORDER * GRID_MAX_ORDER)
+#define GRID_MAX_CELLS (GRID_MAX_SIZE * GRID_MAX_SIZE)
+
+/**
+ * A sudoku of any box order. The values are the givens before solving and
+ * the solution after a successful solve, values above 9 are written as
+ * letters, A for 10 up to P for 25
+ */
+typedef struct _Grid
+{
+    int order;
+    //how many values and how many cells there are
+    int size;
+    int cells;
+    uint8_t values[GRID_MAX_CELLS];
+    //how many guesses the search made
+    int steps;
+    //the solutions found so far, how many we look for and the first one
+    int solutions;
+    int limit;
+    uint8_t first[GRID_MAX_CELLS];
+    //the search gives up once this is set, loading a sudoku sets it to NULL
+    atomic_int *cancel;
+} Grid;
+
+int grid_order_from_length(int length);
+int grid_load_from_char(Grid *g, int order, const char *data);
+int grid_find_invalid_char(int order, const char *data);
+void grid_count_solutions(Grid *g, int limit, int *result, int *count, int *steps);
+void grid_solve(Grid *g, int *result, int *steps);
+int grid_verify(Grid *g, const char *data);
+int grid_get_empty_count(Grid *g);
+char *grid_to_string_simple(Grid *g, char *buff);
+
+#endif // GRID_H
@@ -0,0 +1,280 @@
+/**
+ * The solving kernel of one box order, grid.c includes this file once for
+ * every order with GRID_ORDER and GRID_MASK defined, so it has no include
+ * guard. Every function gets the order in its name. With the order known at
+ * compile time the house loops have a constant length and are unrolled, the
+ * cells of a house are computed instead of looked up in a table, and the
+ * candidates of a cell are the narrowest mask that holds every value.
+ *
+ * The state is small enough that every guess works on its own copy, like the
+ * bitboard engine. Placing a value removes it from the peers of the cell, the
+ * peers that are left with a single candidate are queued as naked singles,
+ * and when the queue runs dry every house is checked for hidden singles
+ */
+
+#define GRID_CAT(a, b) a##_o##b
+#define GRID_NAME(a, b) GRID_CAT(a, b)
+#define GRID_FN(name) GRID_NAME(name, GRID_ORDER)
+
+#define GRID_N (GRID_ORDER * GRID_ORDER)
+#define GRID_CELLS (GRID_N * GRID_N)
+#define GRID_FULL ((GRID_MASK)((1ull << GRID_N) - 1))
+
+/**
+ * The state of the search, the candidates of a filled cell are its value
+ */
+typedef struct
+{
+    GRID_MASK candidates[GRID_CELLS];
+    uint8_t values[GRID_CELLS];
+    int empty;
+} GRID_FN(GridState);
+
+/**
+ * The naked singles that still have to be placed
+ */
+typedef struct
+{
+    int count;
+    uint16_t cells[GRID_CELLS];
+} GRID_FN(GridQueue);
+
+//the k-th cell of a row, a column and a box
+#define GRID_ROW_CELL(r, k) ((r) * GRID_N + (k))
+#define GRID_COL_CELL(c, k) ((k) * GRID_N + (c))
+#define GRID_BOX_CELL(b, k)                                                                                        \
+    ((((b) / GRID_ORDER) * GRID_ORDER + (k) / GRID_ORDER) * GRID_N + ((b) % GRID_ORDER) * GRID_ORDER +               \
+     (k) % GRID_ORDER)
+
+/**
+ * This function removes a value from a peer of a cell that was just filled.
+ * Returns false if that leaves the peer without candidates or the peer
+ * already has the value
+ */
+static inline int GRID_FN(grid_remove)(GRID_FN(GridState) * s, GRID_FN(GridQueue) * q, int peer, int cell,
+                                        GRID_MASK bit)
+{
+    GRID_MASK m = s->candidates[peer];
+    if (!(m & bit) || peer == cell)
+        return 1;
+    if (s->values[peer] != 0)
+        return 0;
+
+    m &= ~bit;
+    s->candidates[peer] = m;
+    if (m == 0)
+        return 0;
+    if ((m & (m - 1)) == 0)
+        q->cells[q->count++] = (uint16_t)peer;
+    return 1;
+}
+
+/**
+ * This function fills a cell and removes its value from the row, the column
+ * and the box. Returns false if the value can't go there
+ */
+static int GRID_FN(grid_place)(GRID_FN(GridState) * s, GRID_FN(GridQueue) * q, int cell, int value)
+{
+    GRID_MASK bit = (GRID_MASK)(1u << (value - 1));
+    if (s->values[cell] != 0)
+        return s->values[cell] == value;
+    if (!(s->candidates[cell] & bit))
+        return 0;
+
+    s->values[cell] = (uint8_t)value;
+    s->candidates[cell] = bit;
+    s->empty--;
+
+    int row = cell / GRID_N;
+    int col = cell % GRID_N;
+    int box = (row / GRID_ORDER) * GRID_ORDER + col / GRID_ORDER;
+    int ok = 1;
+#pragma GCC unroll 25
+    for (int k = 0; k < GRID_N; k++)
+    {
+        ok &= GRID_FN(grid_remove)(s, q, GRID_ROW_CELL(row, k), cell, bit);
+        ok &= GRID_FN(grid_remove)(s, q, GRID_COL_CELL(col, k), cell, bit);
+        ok &= GRID_FN(grid_remove)(s, q, GRID_BOX_CELL(box, k), cell, bit);
+    }
+    return ok;
+}
+
+/**
+ * This function places the naked singles of the queue. Returns false on a contradiction
+ */
+static int GRID_FN(grid_drain)(GRID_FN(GridState) * s, GRID_FN(GridQueue) * q)
+{
+    while (q->count > 0)
+    {
+        int cell = q->cells[--q->count];
+        if (s->values[cell] != 0)
+            continue;
+        if (!GRID_FN(grid_place)(s, q, cell, __builtin_ctz(s->candidates[cell]) + 1))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * This function places the hidden singles of a house, the values that only
+ * one of its cells can take. Returns -1 on a contradiction, a value that no
+ * cell can take, otherwise how many were placed
+ */
+#define GRID_HIDDEN_SINGLES(name, CELL)                                                                            \
+    static int GRID_FN(name)(GRID_FN(GridState) * s, GRID_FN(GridQueue) * q, int house)                            \
+    {                                                                                                              \
+        GRID_MASK once = 0, twice = 0, filled = 0;                                                                 \
+        _Pragma("GCC unroll 25") for (int k = 0; k < GRID_N; k++)                                                  \
+        {                                                                                                          \
+            int cell = CELL(house, k);                                                                             \
+            GRID_MASK m = s->candidates[cell];                                                                     \
+            twice |= once & m;                                                                                     \
+            once |= m;                                                                                             \
+            if (s->values[cell] != 0)                                                                              \
+                filled |= m;                                                                                       \
+        }                                                                                                          \
+        if (once != GRID_FULL)                                                                                     \
+            return -1;                                                                                             \
+                                                                                                                   \
+        GRID_MASK hidden = once & ~twice & ~filled;                                                                \
+        int placed = 0;                                                                                            \
+        _Pragma("GCC unroll 25") for (int k = 0; k < GRID_N && hidden != 0; k++)                                   \
+        {                                                                                                          \
+            int cell = CELL(house, k);                                                                             \
+            GRID_MASK m = s->candidates[cell] & hidden;                                                            \
+            if (m == 0)                                                                                            \
+                continue;                                                                                          \
+            hidden &= ~m;                                                                                          \
+            if ((m & (m - 1)) != 0 || !GRID_FN(grid_place)(s, q, cell, __builtin_ctz(m) + 1))                      \
+                return -1;                                                                                         \
+            placed++;                                                                                              \
+        }                                                                                                          \
+        return placed;                                                                                             \
+    }
+
+GRID_HIDDEN_SINGLES(grid_row_singles, GRID_ROW_CELL)
+GRID_HIDDEN_SINGLES(grid_col_singles, GRID_COL_CELL)
+GRID_HIDDEN_SINGLES(grid_box_singles, GRID_BOX_CELL)
+
+/**
+ * This function places naked and hidden singles until there are none left.
+ * Returns false on a contradiction
+ */
+static int GRID_FN(grid_propagate)(GRID_FN(GridState) * s, GRID_FN(GridQueue) * q)
+{
+    int placed = 1;
+    while (placed > 0)
+    {
+        if (!GRID_FN(grid_drain)(s, q))
+            return 0;
+        if (s->empty == 0)
+            return 1;
+
+        placed = 0;
+        for (int h = 0; h < GRID_N; h++)
+        {
+            int r = GRID_FN(grid_row_singles)(s, q, h);
+            int c = (r < 0) ? -1 : GRID_FN(grid_col_singles)(s, q, h);
+            int b = (c < 0) ? -1 : GRID_FN(grid_box_singles)(s, q, h);
+            if (b < 0 || !GRID_FN(grid_drain)(s, q))
+                return 0;
+            placed += r + c + b;
+        }
+    }
+    return 1;
+}
+
+/**
+ * This function returns the empty cell with the fewest candidates
+ */
+static int GRID_FN(grid_pick_cell)(GRID_FN(GridState) * s)
+{
+    int best = -1;
+    int best_count = GRID_N + 1;
+    for (int i = 0; i < GRID_CELLS; i++)
+    {
+        if (s->values[i] != 0)
+            continue;
+        int count = __builtin_popcount(s->candidates[i]);
+        if (count < best_count)
+        {
+            best = i;
+            best_count = count;
+            if (count == 2)
+                break;
+        }
+    }
+    return best;
+}
+
+/**
+ * This function solves the sudoku from a state by propagating singles and
+ * guessing when it gets stuck. The search stops once g->limit solutions have
+ * been found, the first one is kept in g->first. Returns true once the limit
+ * is reached
+ */
+static int GRID_FN(grid_search)(Grid *g, GRID_FN(GridState) * s, GRID_FN(GridQueue) * q)
+{
+    if (g->cancel != NULL && atomic_load_explicit(g->cancel, memory_order_relaxed))
+        return 1;
+    if (!GRID_FN(grid_propagate)(s, q))
+        return 0;
+
+    if (s->empty == 0)
+    {
+        if (g->solutions == 0)
+            memcpy(g->first, s->values, GRID_CELLS);
+        return ++g->solutions >= g->limit;
+    }
+
+    int cell = GRID_FN(grid_pick_cell)(s);
+    GRID_MASK candidates = s->candidates[cell];
+    while (candidates != 0)
+    {
+        int value = __builtin_ctz(candidates) + 1;
+        candidates &= candidates - 1;
+
+        //try the value on a copy, so that the state is untouched if it fails
+        GRID_FN(GridState) guess = *s;
+        g->steps++;
+        q->count = 0;
+        if (GRID_FN(grid_place)(&guess, q, cell, value) && GRID_FN(grid_search)(g, &guess, q))
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * This function places the givens of a grid and searches for its solutions
+ */
+static void GRID_FN(grid_run)(Grid *g)
+{
+    GRID_FN(GridState) s;
+    GRID_FN(GridQueue) q;
+    for (int i = 0; i < GRID_CELLS; i++)
+    {
+        s.candidates[i] = GRID_FULL;
+        s.values[i] = 0;
+    }
+    s.empty = GRID_CELLS;
+    q.count = 0;
+
+    //a given that doesn't fit makes the sudoku unsolvable
+    for (int i = 0; i < GRID_CELLS; i++)
+    {
+        if (g->values[i] != 0 && !GRID_FN(grid_place)(&s, &q, i, g->values[i]))
+            return;
+    }
+    GRID_FN(grid_search)(g, &s, &q);
+}
+
+#undef GRID_BOX_CELL
+#undef GRID_COL_CELL
+#undef GRID_ROW_CELL
+#undef GRID_HIDDEN_SINGLES
+#undef GRID_FULL
+#undef GRID_CELLS
+#undef GRID_N
+#undef GRID_FN
+#undef GRID_NAME
+#undef GRID_CAT
@@ -1,13 +1,27 @@
 #include <stdio.h>
 #include <time.h>
 #include <limits.h>
+#include <sys/stat.h>
 #include "sudoku.h"
 #include "file.h"
 #include "utils.h"
+#include "pool.h"
+#include "stream.h"
+#include "engine.h"
+#include "perf.h"
+#include "verify.h"
+#include "generate.h"
+#include "symmetry.h"
+#include "cache.h"
+#include "race.h"
+#include "grid.h"
+
+//how many sudokus every solver thread can have in flight when streaming
+#define STREAM_SLOTS_PER_THREAD 64
 
 /*GLOBAL VARS*/
-//the name of the file we want to open
-char filename[40] = "data/hardest_sudokus.txt";
+//the name of the file we want to open, "-" means the standard input
+char *filename = "data/hardest_sudokus.txt";
 
 //whether we want to print the result of each sudoku
 int print = 1;
@@ -22,11 +36,140 @@ int with_pencilmarks = 1;
 //whether we should log the steps and
 //time for each solution
 int log_stats = 0;
-char log_filename[40] = "logs/logs.txt";
+char log_filename[PATH_MAX] = "logs/logs.txt";
 
 //whether we should print the history of the solution step by step to a file
 int print_history = 0;
 
+//how many threads solve the sudokus
+int num_threads = 1;
+
+//the name of the engine that solves the sudokus, if the user doesn't
+//choose one it depends on whether we use pencilmarks
+char *engine_name = NULL;
+
+//the engine that solves the sudokus and its state for every worker
+const SolverEngine *engine = NULL;
+void **engine_states = NULL;
+
+//when it is not 0 the solutions of every sudoku are counted, up until there
+//are this many of them, 2 is enough to tell if the solution is unique
+int count_limit = 0;
+
+//when it is not 0 we generate this many sudokus instead of solving them, they
+//need between min_steps and max_steps steps of the engine, the seed picks them
+int generate_count = 0;
+int min_steps = 0;
+int max_steps = INT_MAX;
+uint64_t seed = 0;
+int have_seed = 0;
+
+//whether we compare the solutions to the expected ones that follow the sudokus
+int check_expected = 0;
+
+//when it is not 0 the solved sudokus are kept by their canonical form in a cache
+//with room for this many of them, so their transformations are answered from it
+int cache_capacity = 0;
+SolvedCache *solved_cache = NULL;
+
+//when it is not 0 every sudoku is solved in this many orientations at once
+//and the first one to finish wins, every worker has its own race
+int race_racers = 0;
+Race **races = NULL;
+
+//when it is not NULL every sudoku is raced by the members of this portfolio
+//instead, see RaceMember, "" means the default portfolio
+char *portfolio = NULL;
+RaceMember race_members[RACE_MAX_RACERS];
+int num_race_members = 0;
+
+//the box order of the sudokus, 3 is the classic 9x9 sudoku that the engines
+//solve, the other orders are solved by the kernels of grid.c
+int grid_order = 3;
+
+//how many threads the engines that split the search of a single sudoku,
+//like the parallel engine, use for it, 0 for one for every processor
+int search_threads = 0;
+
+//whether we count the hardware events of every sudoku, which of the events
+//this machine can count, and the counters of every worker
+int count_perf = 0;
+int perf_available[PERF_EVENTS];
+PerfCounters *perf_counters = NULL;
+
+/**
+ * The result of solving a single sudoku. The workers fill in the results
+ * in any order, the main thread goes through them in the order of the
+ * sudokus and marks them ready as soon as they are filled in
+ */
+typedef struct _SolveResult
+{
+    int result;
+    int steps;
+    int empty_at_start;
+    //how many solutions were found, at most count_limit when we count them
+    int solutions;
+    //one of the VERIFY_* codes for the solution that was found
+    int verified;
+    //whether the solution is the expected one, -1 if we don't compare them
+    int matches_expected;
+    //whether the sudoku was answered from the cache
+    int cached;
+    //the orientation that won the race, -1 if the sudoku wasn't raced
+    int winner;
+    //the nanoseconds it took to solve the sudoku, in total and in every phase
+    int64_t elapsed;
+    int64_t phase_ns[ENGINE_PHASES];
+#if defined(SUDOKU_STATS)
+    //the work of every technique
+    SudokuStats stats;
+#endif
+    //the hardware events while solving, PERF_UNAVAILABLE when they can't be counted
+    int64_t perf[PERF_EVENTS];
+    //the sudoku before and after solving, only when we print
+    char *unsolved_str;
+    char *solved_str;
+    int ready;
+} SolveResult;
+
+/**
+ * The statistics that every worker keeps for the sudokus it solved. Every
+ * worker has its own cache line so that the workers don't slow each other
+ * down, they are merged after all the sudokus are solved
+ */
+typedef struct _WorkerStats
+{
+    int solved;
+    int not_solved;
+    long long steps;
+} __attribute__((aligned(POOL_CACHE_LINE))) WorkerStats;
+
+/**
+ * How many of the solutions were wrong and, when we compare them, how many
+ * didn't match the expected ones
+ */
+typedef struct _Verification
+{
+    int wrong;
+    int compared;
+    int mismatched;
+} Verification;
+
+/**
+ * Everything the workers share while solving a batch of sudokus
+ */
+typedef struct _Batch
+{
+    int num_sudokus;
+    char **sudokus;
+    //the expected solutions, NULL for the sudokus that have none
+    char **expected;
+    SolveResult *results;
+    WorkerStats *stats;
+    pthread_mutex_t lock;
+    pthread_cond_t result_ready;
+} Batch;
+
 #pragma region arguments
 /**
  * This function handles the command line arguments
@@ -46,6 +189,20 @@ void handle_args(int argc, char *argv[])
     char *print_history_arg = "-printhistory";
     char *print_history_arg_abr = "-ph";
     char *history_dir = "history/";
+    char *threads_arg = "-j";
+    char *engine_arg = "--engine";
+    char *engine_arg_abr = "-e";
+    char *perf_arg = "-perf";
+    char *count_arg = "--count";
+    char *check_arg = "--check";
+    char *generate_arg = "--generate";
+    char *difficulty_arg = "--difficulty";
+    char *seed_arg = "--seed";
+    char *cache_arg = "--cache";
+    char *race_arg = "--race";
+    char *portfolio_arg = "--portfolio";
+    char *search_threads_arg = "--search-threads";
+    char *order_arg = "--order";
 
     //the zero'th argument is the program
     //itself, so start from the first arguemnt
@@ -59,11 +216,8 @@ void handle_args(int argc, char *argv[])
             //we need to look at the next argument
             //because that is the name of the file
             i++;
-            //get the filename
-            char *fname = argv[i];
             //put the argument in the global filename variable
-            memset(filename, 0, 40);
-            strcat(filename, fname);
+            filename = argv[i];
         }
 
         //if the user specified that no printing should take place
@@ -106,8 +260,7 @@ void handle_args(int argc, char *argv[])
                 {
                     //this means that the next argument is the name
                     //of the log file
-                    strcpy(log_filename, logs_dir);
-                    strcat(log_filename, argv[++i]);
+                    snprintf(log_filename, sizeof(log_filename), "%s%s", logs_dir, argv[++i]);
                 }
             }
         }
@@ -116,174 +269,1609 @@ void handle_args(int argc, char *argv[])
         {
             print_history = 1;
         }
+        //if the user specified how many threads should solve the sudokus
+        if (strequals(arg, threads_arg))
+        {
+            //we need to look at the next argument
+            //because that will tell us the actual number
+            i++;
+            num_threads = max(atoi(argv[i]), 1);
+        }
+        //if the user specified which engine should solve the sudokus
+        if (strequals(arg, engine_arg) || strequals(arg, engine_arg_abr))
+        {
+            //we need to look at the next argument
+            //because that is the name of the engine
+            i++;
+            engine_name = argv[i];
+        }
+        //if we need to count the solutions of every sudoku
+        if (strequals(arg, count_arg))
+        {
+            //the limit is optional, without it we check if the solution is unique
+            count_limit = 2;
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9')
+            {
+                int limit = atoi(argv[++i]);
+                count_limit = max(limit, 1);
+            }
+        }
+        //if we need to generate sudokus, the next argument is how many
+        if (strequals(arg, generate_arg))
+        {
+            i++;
+            generate_count = atoi(argv[i]);
+        }
+        //the range of steps of the generated sudokus, given as MIN or MIN:MAX
+        if (strequals(arg, difficulty_arg))
+        {
+            i++;
+            char *colon = strchr(argv[i], ':');
+            min_steps = atoi(argv[i]);
+            max_steps = (colon != NULL && colon[1] != '\0') ? atoi(colon + 1) : INT_MAX;
+        }
+        //the seed of the generated sudokus
+        if (strequals(arg, seed_arg))
+        {
+            i++;
+            seed = strtoull(argv[i], NULL, 10);
+            have_seed = 1;
+        }
+        //if we need to keep the solved sudokus in a cache, its capacity is optional
+        if (strequals(arg, cache_arg))
+        {
+            cache_capacity = SOLVED_CACHE_DEFAULT_CAPACITY;
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9')
+            {
+                int capacity = atoi(argv[++i]);
+                cache_capacity = max(capacity, 1);
+            }
+        }
+        //the number of orientations that race for every sudoku
+        if (strequals(arg, race_arg))
+        {
+            i++;
+            int racers = atoi(argv[i]);
+            race_racers = max(racers, 1);
+            race_racers = min(race_racers, RACE_MAX_RACERS);
+        }
+        //the members that race for every sudoku, they are optional
+        if (strequals(arg, portfolio_arg))
+        {
+            portfolio = "";
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                portfolio = argv[++i];
+        }
+        //how many threads search every sudoku together
+        if (strequals(arg, search_threads_arg))
+        {
+            i++;
+            int threads = atoi(argv[i]);
+            search_threads = max(threads, 1);
+        }
+        //the box order of the sudokus, 4 for 16x16 and 5 for 25x25
+        if (strequals(arg, order_arg))
+        {
+            i++;
+            grid_order = atoi(argv[i]);
+        }
+        //if we need to compare the solutions to the expected ones
+        if (strequals(arg, check_arg))
+        {
+            check_expected = 1;
+        }
+        //if we need to count the hardware events of every sudoku
+        if (strequals(arg, perf_arg))
+        {
+            count_perf = 1;
+        }
     }
 }
 
 #pragma endregion
 
 /**
- * The entry point of the program
+ * This function converts the values of an engine to the fancy
+ * string of a sudoku so that all the engines print the same way
  */
-int main(int argc, char *argv[])
+char *values_to_string_fancy(uint8_t *engine_values)
 {
-    //handle the arguments and set the global variables
-    handle_args(argc, argv);
-    //the maximum amount of sudokus we want to read from a file
-    //is the smallest number between the number of sudokus in the file
-    //and the number specified by the user
-    num_sudokus = min(get_number_of_lines_in_file(filename), num_sudokus);
-    //create the string array and load the sudokus
-    char **sud_str_array = create_sudoku_string_array_from_file(filename, num_sudokus);
+    int values[SUDOKU_CELLS];
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        values[i] = engine_values[i];
+    }
 
-    FILE *log_file = NULL;
-    if (log_stats)
+    Sudoku sudoku;
+    sudoku_init(&sudoku);
+    sudoku_load_from_int(&sudoku, values, 0);
+    return sudoku_to_string_fancy(&sudoku, NULL);
+}
+
+/**
+ * This function writes values as a simple string of SUDOKU_STRING_LENGTH chars
+ */
+void values_to_string_simple(uint8_t *values, char *buff)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
     {
-        log_file = fopen(log_filename, "w");
-        fprintf(log_file, "%s, n: %d, pencilmarks: %s\n", filename, num_sudokus, (with_pencilmarks) ? "true" : "false");
+        buff[i] = (char)(values[i] + '0');
     }
+    buff[SUDOKU_CELLS] = '\0';
+}
 
-    //the number of sudokus that we solved
-    int solved = 0;
-    //and those we haven't solved
-    int not_solved = 0;
+/**
+ * This function reads the givens of a sudoku string, 0 for the empty cells
+ */
+void givens_from_string(char *sudoku_str, uint8_t *givens)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        char c = sudoku_str[i];
+        givens[i] = (c >= '1' && c <= '9') ? (uint8_t)(c - '0') : 0;
+    }
+}
 
-    //Arrays to hold information for each attempt
-    //The number of steps it took to get to the solution
-    int *stepsForEach = (int *)malloc(num_sudokus * sizeof(int));
-    //The number of cells that were empty at the start
-    int *emptyAtStartForEach = (int *)malloc(num_sudokus * sizeof(int));
-    //The amount of time needed to find the solution
-    float *timeForEach = (float *)malloc(num_sudokus * sizeof(float));
+/**
+ * This function returns how many of the values are empty
+ */
+int values_count_empty(uint8_t *values)
+{
+    int count = 0;
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        count += values[i] == 0;
+    }
+    return count;
+}
 
-    //set the arrays to start with zeros
-    memset(stepsForEach, 0, num_sudokus);
-    memset(emptyAtStartForEach, 0, num_sudokus);
-    memset(timeForEach, 0, num_sudokus);
+/**
+ * This function solves the sudoku that is loaded in the state of an engine,
+ * or counts its solutions if the user asked us to
+ */
+void run_engine(void *state, SolveResult *res)
+{
+    if (count_limit)
+    {
+        engine->count_solutions(state, count_limit, &res->result, &res->solutions);
+    }
+    else
+    {
+        engine->solve(state, &res->result);
+        res->solutions = res->result == SUDOKU_SOLVED;
+    }
+}
 
-    float avgTime = 0;
-    float avgSteps = 0;
+/**
+ * This function verifies the values an engine found for a sudoku string and,
+ * if the user wants us to, compares them to the expected solution
+ */
+void verify_result(SolveResult *res, uint8_t *values, char *sudoku_str, char *expected)
+{
+    res->verified = (res->result == SUDOKU_SOLVED) ? verify_solution(values, sudoku_str) : VERIFY_OK;
 
-    //get the time where we start solvin
-    float timeWeStartGoingThoughThePuzzles = getTime();
+    res->matches_expected = -1;
+    if (check_expected && expected != NULL)
+        res->matches_expected = res->result == SUDOKU_SOLVED && verify_matches(values, expected);
+}
 
-    //for every sudoku string that we read
-    for (int i = 0; i < num_sudokus; i++)
+/**
+ * This function answers a sudoku from the cache if a transformation of it was
+ * solved before, its solution is mapped back from the canonical form. Returns
+ * false if it was not. The result is filled in like solve_sudoku_string does
+ */
+int solve_from_cache(char *sudoku_str, char *expected, SolveResult *res, char *solution, uint8_t *canonical,
+                     SudokuTransform *transform)
+{
+    SolvedCacheEntry entry;
+    if (!solved_cache_find(solved_cache, canonical, &entry))
+        return 0;
+
+    uint8_t values[SUDOKU_CELLS];
+    givens_from_string(sudoku_str, values);
+    if (print && solution == NULL)
+        res->unsolved_str = values_to_string_fancy(values);
+    res->empty_at_start = values_count_empty(values);
+
+    res->result = entry.result;
+    res->solutions = entry.solutions;
+    res->cached = 1;
+    //nothing was searched
+    res->steps = 0;
+#if defined(SUDOKU_STATS)
+    memset(&res->stats, 0, sizeof(SudokuStats));
+#endif
+    memset(res->perf, 0, sizeof(res->perf));
+
+    if (res->result == SUDOKU_SOLVED)
     {
-        //get the sudoku string
-        char *sud_to_solve = sud_str_array[i];
+        symmetry_from_canonical(transform, entry.values, values);
+        if (solution != NULL)
+            values_to_string_simple(values, solution);
+        else if (print)
+            res->solved_str = values_to_string_fancy(values);
+    }
+    verify_result(res, values, sudoku_str, expected);
+    return 1;
+}
 
-        //create a sudoku intance from the given array
-        Sudoku *s = sudoku_create_from_char(sud_to_solve, with_pencilmarks);
-        sudoku_set_print_history(s, print_history);
+/**
+ * This function solves a sudoku string and fills in its result. If a
+ * solution buffer is given the solved sudoku is written in it as a simple
+ * string, otherwise the fancy strings are kept if the user wants us to print.
+ * Every solution is verified, the expected solution is NULL if there is none.
+ * The worker is the id of the thread that solves it, it picks the state of
+ * the engine that the thread uses
+ */
+void solve_sudoku_string(char *sudoku_str, char *expected, SolveResult *res, char *solution, int worker)
+{
+    void *state = engine_states[worker];
+    uint8_t values[SUDOKU_CELLS];
 
-        if (print) //print the unsolved puzzle if the user wants us to
+    //look for a transformation of the sudoku that was solved before,
+    //finding the canonical form counts as converting the string
+    SudokuTransform transform;
+    uint8_t canonical[SUDOKU_CELLS];
+    int canonicalized = 0;
+    int64_t cacheTime = 0;
+    res->cached = 0;
+    res->winner = -1;
+    if (solved_cache != NULL)
+    {
+        int64_t start = getTimeNs();
+        canonicalized = symmetry_canonicalize(sudoku_str, canonical, &transform);
+        if (canonicalized && solve_from_cache(sudoku_str, expected, res, solution, canonical, &transform))
         {
-            printf("\n\n");
-            sudoku_print(s);
+            memset(res->phase_ns, 0, sizeof(res->phase_ns));
+            res->elapsed = res->phase_ns[ENGINE_PHASE_PARSE] = getTimeNs() - start;
+            return;
         }
+        cacheTime = getTimeNs() - start;
+    }
+
+    //the racers load the sudoku themselves
+    if (races != NULL)
+    {
+        givens_from_string(sudoku_str, values);
+    }
+    else
+    {
+        engine->load_from_char(state, sudoku_str);
+        engine->get_values(state, values);
+    }
 
-        //get how many cells are empty before we start solving for this sudoku
-        emptyAtStartForEach[i] = sudoku_get_empty_indeces(s, NULL);
+    if (print && solution == NULL) //keep the unsolved puzzle if the user wants us to print it
+    {
+        res->unsolved_str = values_to_string_fancy(values);
+    }
 
-        //these ints are given to the solving function in order to
-        //store what the result was and how many steps it took
-        //us to get there
-        int result, steps;
+    //get how many cells are empty before we start solving for this sudoku
+    res->empty_at_start = values_count_empty(values);
 
-        //mark the time at which the function starts running
-        float thisStartTime = getTime();
+    //attempt solve the puzzle, counting the hardware events if the user wants
+    //us to, when racing they are the events of the orientation this thread solves
+    PerfCounters *pc = (count_perf) ? &perf_counters[worker] : NULL;
+    if (pc != NULL)
+    {
+        //the counters count the thread that opens them, so the worker opens its own
+        if (!pc->opened)
+            perf_counters_open(pc);
+        perf_counters_start(pc);
+    }
 
-        //attempt solve the puzzle
-        sudoku_solve(s, &result, &steps);
+    EngineCounters counters;
+    if (races != NULL)
+    {
+        //the winner's solution is already in the orientation of the sudoku
+        res->winner = race_solve(races[worker], sudoku_str, &res->result, values, &counters);
+        res->solutions = res->result == SUDOKU_SOLVED;
+    }
+    else
+    {
+        run_engine(state, res);
+    }
 
-        //mark the time at which the function ends
-        float thisEndTime = getTime();
+    if (pc != NULL)
+        perf_counters_stop(pc, res->perf);
 
-        //calculate the difference in time
-        float elapsed = thisEndTime - thisStartTime;
+    //if the puzzle had a solution verify it and keep the solved instance
+    if (res->result == SUDOKU_SOLVED)
+    {
+        if (races == NULL)
+            engine->get_values(state, values);
+        if (solution != NULL)
+            values_to_string_simple(values, solution);
+        else if (print)
+            res->solved_str = values_to_string_fancy(values);
+    }
+    verify_result(res, values, sudoku_str, expected);
 
-        //put the steps needed and the time used in the appropiate
-        //arrays
-        stepsForEach[i] = steps;
-        timeForEach[i] = elapsed;
+    //keep the solution in canonical form, but not a wrong one
+    if (canonicalized && res->verified == VERIFY_OK)
+    {
+        uint8_t canonicalValues[SUDOKU_CELLS] = {0};
+        if (res->result == SUDOKU_SOLVED)
+            symmetry_to_canonical(&transform, values, canonicalValues);
+        solved_cache_insert(solved_cache, canonical, res->result, res->solutions, canonicalValues);
+    }
 
-        if (log_file != NULL)
+    if (races == NULL)
+    {
+        if (engine->release != NULL)
+            engine->release(state);
+        engine->get_counters(state, &counters);
+    }
+
+    //the engine timed every phase, the time of the sudoku is their sum
+    res->steps = counters.steps;
+#if defined(SUDOKU_STATS)
+    res->stats = counters.stats;
+#endif
+    res->elapsed = 0;
+    for (int p = 0; p < ENGINE_PHASES; p++)
+    {
+        res->phase_ns[p] = counters.phase_ns[p];
+        res->elapsed += counters.phase_ns[p];
+    }
+    res->phase_ns[ENGINE_PHASE_PARSE] += cacheTime;
+    res->elapsed += cacheTime;
+}
+
+/**
+ * This function adds a result to the statistics of a worker
+ */
+void worker_stats_add(WorkerStats *stats, SolveResult *res)
+{
+    if (res->result == SUDOKU_SOLVED)
+        stats->solved++;
+    else
+        stats->not_solved++;
+    stats->steps += res->steps;
+}
+
+/**
+ * This function solves the sudoku at an index of the batch. It is run by
+ * the workers of the thread pool, so it only touches the result of that
+ * sudoku and the statistics of the worker
+ */
+void solve_sudoku_at(void *arg, int worker, int i)
+{
+    Batch *batch = (Batch *)arg;
+    SolveResult *res = &batch->results[i];
+
+    solve_sudoku_string(batch->sudokus[i], batch->expected[i], res, NULL, worker);
+
+    //update the statistics of this worker
+    worker_stats_add(&batch->stats[worker], res);
+
+    //let the main thread know that this result is ready
+    pthread_mutex_lock(&batch->lock);
+    res->ready = 1;
+    pthread_cond_broadcast(&batch->result_ready);
+    pthread_mutex_unlock(&batch->lock);
+}
+
+/**
+ * This function solves the group of sudokus at an index with the batch kernel
+ * of the engine. The sudokus the cache knows are answered from it and the
+ * kernel gets the rest, the ones it can't decide are solved one by one.
+ * The time of the kernel is shared equally by the sudokus it got
+ */
+void solve_sudoku_group_at(void *arg, int worker, int group)
+{
+    Batch *batch = (Batch *)arg;
+    int first = group * engine->batch_lanes;
+    int count = min(batch->num_sudokus - first, engine->batch_lanes);
+
+    //the lanes of the group that the cache doesn't answer
+    char *pending[count];
+    int lanes[count];
+    int numPending = 0;
+    SudokuTransform transforms[count];
+    uint8_t canonical[count][SUDOKU_CELLS];
+    int canonicalized[count];
+    int64_t cacheTime[count];
+    for (int lane = 0; lane < count; lane++)
+    {
+        char *sudoku_str = batch->sudokus[first + lane];
+        SolveResult *res = &batch->results[first + lane];
+        res->cached = 0;
+        res->winner = -1;
+        canonicalized[lane] = 0;
+        cacheTime[lane] = 0;
+        if (solved_cache != NULL)
         {
-            fprintf(log_file, "%d %f %d\n", steps, elapsed, emptyAtStartForEach[i]);
+            int64_t start = getTimeNs();
+            canonicalized[lane] = symmetry_canonicalize(sudoku_str, canonical[lane], &transforms[lane]);
+            if (canonicalized[lane] &&
+                solve_from_cache(sudoku_str, batch->expected[first + lane], res, NULL, canonical[lane],
+                                 &transforms[lane]))
+            {
+                memset(res->phase_ns, 0, sizeof(res->phase_ns));
+                res->elapsed = res->phase_ns[ENGINE_PHASE_PARSE] = getTimeNs() - start;
+                worker_stats_add(&batch->stats[worker], res);
+                continue;
+            }
+            cacheTime[lane] = getTimeNs() - start;
         }
+        lanes[numPending] = lane;
+        pending[numPending++] = sudoku_str;
+    }
 
-        avgTime += elapsed;
-        avgSteps += steps;
+    int results[count];
+    uint8_t values[count][SUDOKU_CELLS];
+    int64_t shared = 0;
 
-        //print how much time went by and how many steps it took us
-        //only if the user wants us to
-        if (print)
+    //the events of the kernel are shared like its time
+    int64_t sharedPerf[PERF_EVENTS];
+    PerfCounters *pc = (count_perf && numPending > 0) ? &perf_counters[worker] : NULL;
+    if (pc != NULL)
+    {
+        if (!pc->opened)
+            perf_counters_open(pc);
+        perf_counters_start(pc);
+    }
+
+    if (numPending > 0)
+    {
+        int64_t thisStartTime = getTimeNs();
+        engine->solve_batch(pending, numPending, results, values);
+        shared = (getTimeNs() - thisStartTime) / numPending;
+    }
+
+    if (pc != NULL)
+    {
+        perf_counters_stop(pc, sharedPerf);
+        for (int e = 0; e < PERF_EVENTS; e++)
         {
-            printf("Solved in %f seconds\n", elapsed);
-            printf("Solved in %d steps\n\n", steps);
+            if (sharedPerf[e] != PERF_UNAVAILABLE)
+                sharedPerf[e] /= numPending;
         }
-        //if the puzzle had a solution
-        if (result == SUDOKU_SOLVED)
-        {
+    }
 
-            if (print) //print the solved instance of the puzzle if the user wants us to
-                sudoku_print(s);
-            //and increase the number of sudokus we have successfully solved by 1;
-            solved++;
+    for (int k = 0; k < numPending; k++)
+    {
+        int lane = lanes[k];
+        char *sudoku_str = batch->sudokus[first + lane];
+        SolveResult *res = &batch->results[first + lane];
+
+        //the sudoku needs guessing so the scalar path takes over,
+        //the kernel was propagation that didn't get far enough
+        if (results[k] == SUDOKU_UNDECIDED)
+        {
+            //it looks the sudoku up again and keeps its solution
+            solve_sudoku_string(sudoku_str, batch->expected[first + lane], res, NULL, worker);
+            res->phase_ns[ENGINE_PHASE_PROPAGATE] += shared;
+            res->elapsed += shared;
+            for (int e = 0; pc != NULL && e < PERF_EVENTS; e++)
+            {
+                if (res->perf[e] != PERF_UNAVAILABLE && sharedPerf[e] != PERF_UNAVAILABLE)
+                    res->perf[e] += sharedPerf[e];
+            }
         }
-        else //otherwise if the sudoku hasn't been solved
+        else
         {
-            //inform the user that that puzzle has no solution
-            //but only if he wants us to
+            uint8_t givens[SUDOKU_CELLS];
+            givens_from_string(sudoku_str, givens);
             if (print)
-                printf("This sudoku puzzle has no solution\n\n");
+                res->unsolved_str = values_to_string_fancy(givens);
+
+            res->empty_at_start = values_count_empty(givens);
+            res->result = results[k];
+            res->solutions = res->result == SUDOKU_SOLVED;
+            //no guesses were needed, everything was propagation
+            res->steps = 0;
+#if defined(SUDOKU_STATS)
+            memset(&res->stats, 0, sizeof(SudokuStats));
+#endif
+            memset(res->phase_ns, 0, sizeof(res->phase_ns));
+            res->phase_ns[ENGINE_PHASE_PROPAGATE] = shared;
+            res->phase_ns[ENGINE_PHASE_PARSE] = cacheTime[lane];
+            res->elapsed = shared + cacheTime[lane];
+            if (pc != NULL)
+                memcpy(res->perf, sharedPerf, sizeof(res->perf));
 
-            //and increase the number of sudokus we couldn't solve by 1
-            not_solved++;
+            if (print && res->result == SUDOKU_SOLVED)
+                res->solved_str = values_to_string_fancy(values[k]);
+            verify_result(res, values[k], sudoku_str, batch->expected[first + lane]);
+
+            //keep the solution in canonical form like the scalar path, but not a wrong one
+            if (canonicalized[lane] && res->verified == VERIFY_OK)
+            {
+                uint8_t canonicalValues[SUDOKU_CELLS] = {0};
+                if (res->result == SUDOKU_SOLVED)
+                    symmetry_to_canonical(&transforms[lane], values[k], canonicalValues);
+                solved_cache_insert(solved_cache, canonical[lane], res->result, res->solutions,
+                                    canonicalValues);
+            }
         }
 
-        //free the sudoku we created
-        sudoku_free(s);
+        worker_stats_add(&batch->stats[worker], res);
     }
 
-    if (log_file != NULL)
+    //let the main thread know that the results of the group are ready
+    pthread_mutex_lock(&batch->lock);
+    for (int lane = 0; lane < count; lane++)
     {
-        fclose(log_file);
+        batch->results[first + lane].ready = 1;
     }
+    pthread_cond_broadcast(&batch->result_ready);
+    pthread_mutex_unlock(&batch->lock);
+}
 
-    avgSteps /= num_sudokus;
-    avgTime /= num_sudokus;
-
-    //get the time after we have solved all the puzzles
-    float timeWeFinishGoingThoughThePuzzle = getTime();
-    //and calculate how much time elapsed since the start
+/**
+ * This function blocks until the result of the sudoku at an index is ready
+ */
+SolveResult *wait_for_result(Batch *batch, int i)
+{
+    pthread_mutex_lock(&batch->lock);
+    while (!batch->results[i].ready)
+    {
+        pthread_cond_wait(&batch->result_ready, &batch->lock);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return &batch->results[i];
+}
 
-    float totalTime = timeWeFinishGoingThoughThePuzzle - timeWeStartGoingThoughThePuzzles;
+/**
+ * This function writes the first line of the log, it describes the run
+ * and names the columns that follow the steps, the time and the empty cells
+ */
+void log_header(FILE *log_file, char *n)
+{
+    fprintf(log_file, "%s, n: %s, pencilmarks: %s, engine: %s, columns: steps time empty", filename, n,
+            (with_pencilmarks) ? "true" : "false", engine->name);
+    for (int p = 0; p < ENGINE_PHASES; p++)
+    {
+        fprintf(log_file, " %s_ns", ENGINE_PHASE_NAMES[p]);
+    }
+#if defined(SUDOKU_STATS)
+    fprintf(log_file, " naked_singles hidden_singles naked_partner_eliminations guesses backtracks max_depth mask_updates");
+#endif
+    for (int e = 0; count_perf && e < PERF_EVENTS; e++)
+    {
+        fprintf(log_file, " %s", PERF_EVENT_NAMES[e]);
+    }
+    if (count_limit)
+        fprintf(log_file, " solutions");
+    fprintf(log_file, "\n");
+}
 
-    //sort the three metric arrays, so that we can get the median values
-    qsort(stepsForEach, num_sudokus, sizeof(int), compare_int);
-    qsort(emptyAtStartForEach, num_sudokus, sizeof(int), compare_int);
-    qsort(timeForEach, num_sudokus, sizeof(int), compare_float);
+/**
+ * This function writes the line of a result to the log. The time is in seconds,
+ * it is followed by the nanoseconds of every phase and, when they are built in,
+ * the counters of every technique
+ */
+void log_result(FILE *log_file, SolveResult *res)
+{
+    fprintf(log_file, "%d %.9f %d", res->steps, res->elapsed / 1e9, res->empty_at_start);
+    for (int p = 0; p < ENGINE_PHASES; p++)
+    {
+        fprintf(log_file, " %lld", (long long)res->phase_ns[p]);
+    }
+#if defined(SUDOKU_STATS)
+    SudokuStats *st = &res->stats;
+    fprintf(log_file, " %d %d %d %d %d %d %d", st->naked_singles, st->hidden_singles, st->naked_partner_eliminations,
+            st->guesses, st->backtracks, st->max_depth, st->mask_updates);
+#endif
+    for (int e = 0; count_perf && e < PERF_EVENTS; e++)
+    {
+        fprintf(log_file, " %lld", (long long)res->perf[e]);
+    }
+    if (count_limit)
+        fprintf(log_file, " %d", res->solutions);
+    fprintf(log_file, "\n");
+}
 
-    //allocate some memory so that we can print the time easier
+/**
+ * This function prints the average time that every phase took
+ */
+void print_phase_breakdown(FILE *out, int64_t *phase_total, int n)
+{
     char timeBuff[40];
+    n = max(n, 1);
+    fprintf(out, "Average time per phase:");
+    for (int p = 0; p < ENGINE_PHASES; p++)
+    {
+        fprintf(out, "%s %s %s", (p > 0) ? "," : "", ENGINE_PHASE_NAMES[p],
+                format_duration_ns(phase_total[p] / n, timeBuff, 40));
+    }
+    fprintf(out, "\n");
+}
 
-    //inform the user about the final results
-    printf("Attempted to solve %d sudoku%s\n", num_sudokus, (num_sudokus != 1) ? "s" : "");
-    printf("For %d of them a solution was found\n", solved);
-    printf("%.2f%% of the sudokus were solved\n", 100 * (float)solved / (num_sudokus));
-    printf("Median steps until solution %d\n", stepsForEach[num_sudokus / 2]);
-    printf("Average steps for solution %.0f\n", avgSteps);
-    printf("Median empty cells at start %d\n", emptyAtStartForEach[num_sudokus / 2]);
-    printf("Median time for solution %.4fs\n", timeForEach[num_sudokus / 2]);
-    printf("Average time for solution %.4fs\n", avgTime);
-
-    printf("Total time: %s\n", format_time_seconds(totalTime, timeBuff, 40));
+/**
+ * This function prints how many of the sudokus have a unique solution,
+ * which we only know when we count at least two solutions
+ */
+void print_uniqueness(FILE *out, int unique, int multiple, int none)
+{
+    if (count_limit < 2)
+        return;
+
+    fprintf(out, "Sudokus with a unique solution %d, with more than one %d, with none %d\n", unique, multiple, none);
+}
+
+/**
+ * This function adds the verification of a result to the totals
+ */
+void verification_add(Verification *v, SolveResult *res)
+{
+    v->wrong += res->verified != VERIFY_OK;
+    v->compared += res->matches_expected >= 0;
+    v->mismatched += res->matches_expected == 0;
+}
+
+/**
+ * This function prints how many solutions were wrong and how many
+ * didn't match the expected ones
+ */
+void print_verification(FILE *out, Verification *v, int solved)
+{
+    fprintf(out, "Verified %d solution%s, %d %s wrong\n", solved, (solved != 1) ? "s" : "", v->wrong,
+            (v->wrong != 1) ? "were" : "was");
+    if (check_expected)
+    {
+        fprintf(out, "Compared %d sudoku%s to the expected solution, %d didn't match\n", v->compared,
+                (v->compared != 1) ? "s" : "", v->mismatched);
+    }
+}
+
+/**
+ * This function prints how many sudokus were answered from the cache
+ */
+void print_cache_summary(FILE *out, int hits, int n)
+{
+    if (solved_cache == NULL)
+        return;
+
+    fprintf(out, "Answered %d of %d sudoku%s from the cache of %d canonical forms\n", hits, n, (n != 1) ? "s" : "",
+            solved_cache->size);
+}
+
+/**
+ * This function prints how many races every member won
+ */
+void print_race_summary(FILE *out, int *wins)
+{
+    if (races == NULL)
+        return;
+
+    fprintf(out, "Races won by every member:");
+    for (int k = 0; k < num_race_members; k++)
+    {
+        fprintf(out, "%s %s %d", (k > 0) ? "," : "", race_members[k].name, wins[k]);
+    }
+    fprintf(out, "\n");
+}
+
+/**
+ * This function adds the hardware events of a result to the totals
+ */
+void perf_add(int64_t *perf_total, SolveResult *res)
+{
+    for (int e = 0; count_perf && e < PERF_EVENTS; e++)
+    {
+        if (res->perf[e] != PERF_UNAVAILABLE)
+            perf_total[e] += res->perf[e];
+    }
+}
+
+/**
+ * This function prints the hardware events of all the sudokus, the instructions
+ * per cycle, the average of every event and the misses for every step
+ */
+void print_perf_summary(FILE *out, int64_t *perf_total, int n, long long steps)
+{
+    if (!count_perf)
+        return;
+
+    n = max(n, 1);
+    if (perf_available[PERF_CYCLES] && perf_available[PERF_INSTRUCTIONS] && perf_total[PERF_CYCLES] > 0)
+    {
+        fprintf(out, "Instructions per cycle %.2f\n", (double)perf_total[PERF_INSTRUCTIONS] / perf_total[PERF_CYCLES]);
+    }
+
+    fprintf(out, "Average events per sudoku:");
+    for (int e = 0, first = 1; e < PERF_EVENTS; e++)
+    {
+        if (!perf_available[e])
+            continue;
+        fprintf(out, "%s %s %.0f", (first) ? "" : ",", PERF_EVENT_NAMES[e], (double)perf_total[e] / n);
+        first = 0;
+    }
+    fprintf(out, "\n");
+
+    //the misses are what the steps cost, the steps are guesses so there may be none
+    if (steps > 0)
+    {
+        fprintf(out, "Misses per step:");
+        for (int e = PERF_L1D_MISSES, first = 1; e < PERF_EVENTS; e++)
+        {
+            if (!perf_available[e])
+                continue;
+            fprintf(out, "%s %s %.2f", (first) ? "" : ",", PERF_EVENT_NAMES[e], (double)perf_total[e] / steps);
+            first = 0;
+        }
+        fprintf(out, "\n");
+    }
+}
+
+/**
+ * This function solves all the sudokus of a file. The whole file is loaded
+ * so that the medians of every metric can be reported in the end
+ */
+int solve_sudoku_file()
+{
+    //load the sudokus, the maximum amount of sudokus we want to read from
+    //a file is the smallest number between the number of sudokus in the file
+    //and the number specified by the user
+    SudokuFile *sudoku_file = sudoku_file_open(filename, num_sudokus);
+    if (sudoku_file == NULL)
+    {
+        printf("Could not open %s\n", filename);
+        return 1;
+    }
+    num_sudokus = sudoku_file->num_sudokus;
+
+    FILE *log_file = NULL;
+    if (log_stats)
+    {
+        log_file = fopen(log_filename, "w");
+        char n[12];
+        sprintf(n, "%d", num_sudokus);
+        log_header(log_file, n);
+    }
+
+    //Arrays to hold information for each attempt
+    //The number of steps it took to get to the solution
+    int *stepsForEach = (int *)malloc(num_sudokus * sizeof(int));
+    //The number of cells that were empty at the start
+    int *emptyAtStartForEach = (int *)malloc(num_sudokus * sizeof(int));
+    //The nanoseconds needed to find the solution
+    int64_t *timeForEach = (int64_t *)malloc(num_sudokus * sizeof(int64_t));
+
+    //set the arrays to start with zeros
+    memset(stepsForEach, 0, num_sudokus * sizeof(int));
+    memset(emptyAtStartForEach, 0, num_sudokus * sizeof(int));
+    memset(timeForEach, 0, num_sudokus * sizeof(int64_t));
+
+    //the nanoseconds of all the sudokus, in total and in every phase
+    int64_t totalElapsed = 0;
+    int64_t phaseTotal[ENGINE_PHASES] = {0};
+    int64_t perfTotal[PERF_EVENTS] = {0};
+    float avgSteps = 0;
+    //how many sudokus have one, more than one and no solutions
+    int solutionCounts[3] = {0};
+    Verification verification = {0};
+    int cacheHits = 0;
+    int raceWins[RACE_MAX_RACERS] = {0};
+
+    //allocate some memory so that we can print the time easier
+    char timeBuff[40];
+
+    //everything the workers need to solve the sudokus
+    Batch batch;
+    batch.num_sudokus = num_sudokus;
+    batch.sudokus = sudoku_file->sudokus;
+    batch.expected = sudoku_file->solutions;
+    batch.results = (SolveResult *)calloc(num_sudokus, sizeof(SolveResult));
+    batch.stats = (WorkerStats *)aligned_alloc(POOL_CACHE_LINE, num_threads * sizeof(WorkerStats));
+    memset(batch.stats, 0, num_threads * sizeof(WorkerStats));
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.result_ready, NULL);
+
+    //get the time where we start solvin
+    int64_t timeWeStartGoingThoughThePuzzles = getTimeNs();
+
+    //start the workers, they solve the sudokus while we go through the results,
+    //with the vector kernel every task is a group of sudokus
+    //the kernel can't count solutions
+    int batched = engine->solve_batch != NULL && !count_limit;
+    int num_tasks = (batched) ? (num_sudokus + engine->batch_lanes - 1) / engine->batch_lanes : num_sudokus;
+    ThreadPool *pool = pool_start(num_threads, num_tasks, pool_default_chunk_size(num_threads, num_tasks),
+                                  (batched) ? solve_sudoku_group_at : solve_sudoku_at, &batch);
+
+    //for every sudoku string that we read, in the order of the file
+    for (int i = 0; i < num_sudokus; i++)
+    {
+        //wait until a worker has solved it
+        SolveResult *res = wait_for_result(&batch, i);
+
+        if (print) //print the unsolved puzzle if the user wants us to
+        {
+            printf("\n\n");
+            printf("%s\n", res->unsolved_str);
+        }
+
+        emptyAtStartForEach[i] = res->empty_at_start;
+
+        //put the steps needed and the time used in the appropiate
+        //arrays
+        stepsForEach[i] = res->steps;
+        timeForEach[i] = res->elapsed;
 
-    //free the string array
-    sudoku_free_string_array(sud_str_array, num_sudokus);
+        if (log_file != NULL)
+        {
+            log_result(log_file, res);
+        }
+
+        totalElapsed += res->elapsed;
+        for (int p = 0; p < ENGINE_PHASES; p++)
+        {
+            phaseTotal[p] += res->phase_ns[p];
+        }
+        perf_add(perfTotal, res);
+        solutionCounts[min(res->solutions, 2)]++;
+        verification_add(&verification, res);
+        cacheHits += res->cached;
+        if (res->winner >= 0)
+            raceWins[res->winner]++;
+
+        //print how much time went by and how many steps it took us
+        //only if the user wants us to
+        if (print)
+        {
+            printf("Solved in %s\n", format_duration_ns(res->elapsed, timeBuff, 40));
+            printf("Solved in %d steps\n", res->steps);
+            if (count_limit)
+                printf("Found %s%d solution%s\n", (res->solutions >= count_limit) ? "at least " : "", res->solutions,
+                       (res->solutions != 1) ? "s" : "");
+            printf("\n");
+        }
+        //if the puzzle had a solution
+        if (res->result == SUDOKU_SOLVED)
+        {
+            if (print) //print the solved instance of the puzzle if the user wants us to
+                printf("%s\n", res->solved_str);
+            if (print && res->verified != VERIFY_OK)
+                printf("This solution is wrong\n\n");
+        }
+        else //otherwise if the sudoku hasn't been solved
+        {
+            //inform the user that that puzzle has no solution
+            //but only if he wants us to
+            if (print)
+                printf("This sudoku puzzle has no solution\n\n");
+        }
+
+        if (print && res->matches_expected == 0)
+            printf("This solution is not the expected one\n\n");
+
+        free(res->unsolved_str);
+        free(res->solved_str);
+    }
+
+    //all the results are in, wait for the workers to finish
+    pool_wait(pool);
+
+    //merge the statistics of the workers
+    //the number of sudokus that we solved
+    int solved = 0;
+    //and those we haven't solved
+    int not_solved = 0;
+    long long totalSteps = 0;
+    for (int i = 0; i < num_threads; i++)
+    {
+        solved += batch.stats[i].solved;
+        not_solved += batch.stats[i].not_solved;
+        totalSteps += batch.stats[i].steps;
+    }
+
+    if (log_file != NULL)
+    {
+        fclose(log_file);
+    }
+
+    //the averages of an empty file are 0 instead of a division by zero
+    int n = max(num_sudokus, 1);
+    avgSteps = (float)totalSteps / n;
+
+    //get the time after we have solved all the puzzles
+    int64_t timeWeFinishGoingThoughThePuzzle = getTimeNs();
+    //and calculate how much time elapsed since the start
+    float totalTime = (float)((timeWeFinishGoingThoughThePuzzle - timeWeStartGoingThoughThePuzzles) / 1e9);
+
+    //sort the three metric arrays, so that we can get the median values
+    qsort(stepsForEach, num_sudokus, sizeof(int), compare_int);
+    qsort(emptyAtStartForEach, num_sudokus, sizeof(int), compare_int);
+    qsort(timeForEach, num_sudokus, sizeof(int64_t), compare_int64);
+
+    //inform the user about the final results
+    printf("Attempted to solve %d sudoku%s\n", num_sudokus, (num_sudokus != 1) ? "s" : "");
+    printf("For %d of them a solution was found\n", solved);
+    printf("%.2f%% of the sudokus were solved\n", 100 * (float)solved / n);
+    //there are no medians or averages of solutions when none were found
+    if (solved > 0)
+    {
+        printf("Median steps until solution %d\n", stepsForEach[num_sudokus / 2]);
+        printf("Average steps for solution %.0f\n", avgSteps);
+        printf("Median empty cells at start %d\n", emptyAtStartForEach[num_sudokus / 2]);
+        printf("Median time for solution %s\n", format_duration_ns(timeForEach[num_sudokus / 2], timeBuff, 40));
+        //racing is about the slowest sudokus, so the tail is worth knowing
+        printf("99th percentile time for solution %s\n",
+               format_duration_ns(timeForEach[(int)(num_sudokus * 0.99)], timeBuff, 40));
+        printf("Average time for solution %s\n", format_duration_ns(totalElapsed / n, timeBuff, 40));
+    }
+    print_phase_breakdown(stdout, phaseTotal, n);
+    print_perf_summary(stdout, perfTotal, n, totalSteps);
+    print_uniqueness(stdout, solutionCounts[1], solutionCounts[2], solutionCounts[0]);
+    print_verification(stdout, &verification, solved);
+    print_cache_summary(stdout, cacheHits, num_sudokus);
+    print_race_summary(stdout, raceWins);
+
+    printf("Total time: %s\n", format_time_seconds(totalTime, timeBuff, 40));
+
+    //close the file of the sudokus
+    sudoku_file_close(sudoku_file);
     //and the three metric arrays
     free(stepsForEach);
     free(emptyAtStartForEach);
     free(timeForEach);
+    //and everything the workers shared
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.result_ready);
+    free(batch.results);
+    free(batch.stats);
+
+    return 0;
+}
+
+/**
+ * The result of a sudoku that was read from a stream, the solution
+ * is written in the slot so that no memory is allocated per sudoku
+ */
+typedef struct _StreamResult
+{
+    SolveResult res;
+    char solution[SUDOKU_STRING_LENGTH + 1];
+} StreamResult;
+
+/**
+ * The statistics of a stream. Only the thread that writes the results
+ * touches them. The steps and times are only averaged, because the medians
+ * would need every value to be kept, the empty cells fit in a histogram
+ */
+typedef struct _StreamStats
+{
+    int attempted;
+    int solved;
+    long long steps;
+    //the nanoseconds of all the sudokus, in total and in every phase
+    int64_t time;
+    int64_t phase_time[ENGINE_PHASES];
+    int64_t perf[PERF_EVENTS];
+    //how many sudokus have one, more than one and no solutions
+    int solutions[3];
+    Verification verification;
+    int cache_hits;
+    int race_wins[RACE_MAX_RACERS];
+    int empty_at_start[SUDOKU_CELLS + 1];
+    FILE *log_file;
+} StreamStats;
+
+/**
+ * This function solves a sudoku that was read from the stream
+ */
+void solve_stream_sudoku(void *arg, int worker, char *sudoku, char *expected, void *result)
+{
+    //the stream stats are only touched when the results are written
+    (void)arg;
+    StreamResult *sr = (StreamResult *)result;
+    solve_sudoku_string(sudoku, expected, &sr->res, sr->solution, worker);
+}
+
+/**
+ * This function writes the result of a sudoku that was read from the stream.
+ * Every sudoku gets one line with the puzzle and its solution, the solution
+ * is left empty when there is none and followed by the number of solutions
+ * when we count them
+ */
+void write_stream_result(void *arg, char *sudoku, void *result)
+{
+    StreamStats *stats = (StreamStats *)arg;
+    SolveResult *res = &((StreamResult *)result)->res;
+
+    if (print)
+    {
+        char *solution = (res->result == SUDOKU_SOLVED) ? ((StreamResult *)result)->solution : "";
+        if (count_limit)
+            printf("%s,%s,%d\n", sudoku, solution, res->solutions);
+        else
+            printf("%s,%s\n", sudoku, solution);
+    }
+
+    if (stats->log_file != NULL)
+    {
+        log_result(stats->log_file, res);
+    }
+
+    stats->attempted++;
+    if (res->result == SUDOKU_SOLVED)
+        stats->solved++;
+    stats->steps += res->steps;
+    stats->time += res->elapsed;
+    for (int p = 0; p < ENGINE_PHASES; p++)
+    {
+        stats->phase_time[p] += res->phase_ns[p];
+    }
+    perf_add(stats->perf, res);
+    stats->solutions[min(res->solutions, 2)]++;
+    verification_add(&stats->verification, res);
+    stats->cache_hits += res->cached;
+    if (res->winner >= 0)
+        stats->race_wins[res->winner]++;
+
+    //the results go to the standard output, so the problems go to the standard error
+    if (res->verified != VERIFY_OK)
+        fprintf(stderr, "The solution of %s is wrong\n", sudoku);
+    if (res->matches_expected == 0)
+        fprintf(stderr, "The solution of %s is not the expected one\n", sudoku);
+    stats->empty_at_start[res->empty_at_start]++;
+}
+
+/**
+ * This function solves the sudokus of a stream as they are read. Only a fixed
+ * number of sudokus is held in memory, so the input can be as long as it wants.
+ * The results go to the standard output so the summary goes to the standard error
+ */
+int solve_sudoku_stream(FILE *in)
+{
+    StreamStats stats;
+    memset(&stats, 0, sizeof(StreamStats));
+
+    if (log_stats)
+    {
+        stats.log_file = fopen(log_filename, "w");
+        log_header(stats.log_file, "stream");
+    }
+
+    //get the time where we start solving
+    int64_t timeWeStartGoingThoughThePuzzles = getTimeNs();
+
+    stream_run(in, num_sudokus, num_threads, num_threads * STREAM_SLOTS_PER_THREAD, sizeof(StreamResult),
+               solve_stream_sudoku, write_stream_result, &stats);
+
+    float totalTime = (float)((getTimeNs() - timeWeStartGoingThoughThePuzzles) / 1e9);
+
+    if (stats.log_file != NULL)
+    {
+        fclose(stats.log_file);
+    }
+
+    //the median of the empty cells is in the bucket where we pass half the
+    //sudokus, it is 0 when there were none
+    int medianEmpty = 0;
+    for (int seen = 0; stats.attempted > 0 && medianEmpty <= SUDOKU_CELLS; medianEmpty++)
+    {
+        seen += stats.empty_at_start[medianEmpty];
+        if (seen > stats.attempted / 2)
+            break;
+    }
+
+    int n = max(stats.attempted, 1);
+    char timeBuff[40];
+
+    //inform the user about the final results
+    fprintf(stderr, "Attempted to solve %d sudoku%s\n", stats.attempted, (stats.attempted != 1) ? "s" : "");
+    fprintf(stderr, "For %d of them a solution was found\n", stats.solved);
+    fprintf(stderr, "%.2f%% of the sudokus were solved\n", 100 * (float)stats.solved / n);
+    fprintf(stderr, "Average steps for solution %.0f\n", (float)stats.steps / n);
+    fprintf(stderr, "Median empty cells at start %d\n", medianEmpty);
+    fprintf(stderr, "Average time for solution %s\n", format_duration_ns(stats.time / n, timeBuff, 40));
+    print_phase_breakdown(stderr, stats.phase_time, n);
+    print_perf_summary(stderr, stats.perf, n, stats.steps);
+    print_uniqueness(stderr, stats.solutions[1], stats.solutions[2], stats.solutions[0]);
+    print_verification(stderr, &stats.verification, stats.solved);
+    print_cache_summary(stderr, stats.cache_hits, stats.attempted);
+    print_race_summary(stderr, stats.race_wins);
+    fprintf(stderr, "Total time: %s\n", format_time_seconds(totalTime, timeBuff, 40));
+
+    return 0;
+}
+
+/**
+ * Everything the workers share while generating sudokus
+ */
+typedef struct _GenerateRun
+{
+    Generator **generators;
+    WorkerStats *stats;
+} GenerateRun;
+
+/**
+ * This function generates the sudoku at an index. It is run by the workers
+ * of the thread pool, every sudoku has its own seed so the same seed makes
+ * the same sudokus with any number of threads. The sudokus are written as
+ * soon as they are made, so their order depends on the threads
+ */
+void generate_sudoku_at(void *arg, int worker, int i)
+{
+    GenerateRun *run = (GenerateRun *)arg;
+    Generator *g = run->generators[worker];
+    WorkerStats *stats = &run->stats[worker];
+
+    char line[SUDOKU_STRING_LENGTH + 2];
+    generator_seed(g, seed + (uint64_t)i);
+    int steps = generator_next(g, line);
+    if (steps < 0)
+    {
+        stats->not_solved++;
+        return;
+    }
+
+    stats->solved++;
+    stats->steps += steps;
+
+    //a whole line is written at once so the lines of the threads don't mix
+    if (print)
+    {
+        line[SUDOKU_STRING_LENGTH] = '\n';
+        fwrite(line, 1, SUDOKU_STRING_LENGTH + 1, stdout);
+    }
+}
+
+/**
+ * This function generates the sudokus the user asked for and writes them to the
+ * standard output, one per line like the files in data/. The summary goes
+ * to the standard error
+ */
+int generate_sudokus()
+{
+    if (!have_seed)
+        seed = (uint64_t)getTimeNs();
+
+    GenerateRun run;
+    run.generators = (Generator **)malloc(num_threads * sizeof(Generator *));
+    run.stats = (WorkerStats *)aligned_alloc(POOL_CACHE_LINE, num_threads * sizeof(WorkerStats));
+    memset(run.stats, 0, num_threads * sizeof(WorkerStats));
+    for (int i = 0; i < num_threads; i++)
+    {
+        run.generators[i] = create_generator(seed, engine, min_steps, max_steps);
+    }
+
+    int64_t start = getTimeNs();
+    ThreadPool *pool = pool_start(num_threads, generate_count, pool_default_chunk_size(num_threads, generate_count),
+                                  generate_sudoku_at, &run);
+    pool_wait(pool);
+    float totalTime = (float)((getTimeNs() - start) / 1e9);
+
+    //merge the statistics of the workers
+    long generated = 0;
+    long failed = 0;
+    long candidates = 0;
+    long long totalSteps = 0;
+    for (int i = 0; i < num_threads; i++)
+    {
+        generated += run.stats[i].solved;
+        failed += run.stats[i].not_solved;
+        totalSteps += run.stats[i].steps;
+        candidates += run.generators[i]->candidates;
+        generator_free(run.generators[i]);
+    }
+    free(run.generators);
+    free(run.stats);
+
+    //the macros evaluate their arguments as they are, so clamp them first
+    float seconds = max(totalTime, 1e-9f);
+    long n = max(generated, 1);
+    long tried = max(candidates, 1);
+
+    char timeBuff[40];
+    fprintf(stderr, "Generated %ld sudoku%s in %s, %.0f per second\n", generated, (generated != 1) ? "s" : "",
+            format_time_seconds(totalTime, timeBuff, 40), generated / seconds);
+    fprintf(stderr, "%ld candidates were made, %.2f%% of them were in the range of steps\n", candidates,
+            100.0 * generated / tried);
+    fprintf(stderr, "Average steps of the %s engine %.1f\n", engine->name, (double)totalSteps / n);
+    if (failed > 0)
+    {
+        fprintf(stderr, "Gave up on %ld sudoku%s after %d candidates out of the range each\n", failed,
+                (failed != 1) ? "s" : "", GENERATOR_MAX_CANDIDATES);
+    }
+
+    return failed > 0;
+}
+
+/**
+ * The result of solving a grid of another order than 9x9
+ */
+typedef struct _GridResult
+{
+    int result;
+    int steps;
+    int solutions;
+    int verified;
+    int64_t elapsed;
+    //the solution as a string, NULL if there is none
+    char *solution;
+} GridResult;
+
+/**
+ * Everything the workers share while solving grids
+ */
+typedef struct _GridRun
+{
+    char **lines;
+    GridResult *results;
+    //the grid of every worker
+    Grid *grids;
+} GridRun;
+
+/**
+ * This function solves the grid at an index, it is run by the workers of the thread pool
+ */
+void solve_grid_at(void *arg, int worker, int i)
+{
+    GridRun *run = (GridRun *)arg;
+    GridResult *res = &run->results[i];
+    Grid *g = &run->grids[worker];
+
+    int64_t start = getTimeNs();
+    res->solution = NULL;
+    res->verified = 1;
+    if (!grid_load_from_char(g, grid_order, run->lines[i]))
+    {
+        res->result = SUDOKU_NO_SOLUTUION;
+        res->steps = 0;
+        res->solutions = 0;
+        res->elapsed = getTimeNs() - start;
+        return;
+    }
+
+    int limit = (count_limit) ? count_limit : 1;
+    grid_count_solutions(g, limit, &res->result, &res->solutions, &res->steps);
+    res->elapsed = getTimeNs() - start;
+
+    if (res->result == SUDOKU_SOLVED)
+    {
+        res->verified = grid_verify(g, run->lines[i]);
+        res->solution = grid_to_string_simple(g, NULL);
+    }
+}
+
+/**
+ * This function returns the first option the user gave that only works on
+ * 9x9 sudokus, the grids of other orders are not solved by the engines. Returns
+ * NULL if there is none
+ */
+char *grid_unsupported_option()
+{
+    if (engine_name != NULL)
+        return "--engine";
+    if (race_racers > 0)
+        return "--race";
+    if (portfolio != NULL)
+        return "--portfolio";
+    if (cache_capacity > 0)
+        return "--cache";
+    if (generate_count > 0)
+        return "--generate";
+    if (log_stats)
+        return "-log";
+    if (print_history)
+        return "-printhistory";
+    if (count_perf)
+        return "-perf";
+    if (check_expected)
+        return "--check";
+    if (search_threads > 0)
+        return "--search-threads";
+    return NULL;
+}
+
+/**
+ * This function solves grids of another order than 9x9, one per line. They
+ * are written like the sudokus of data/ with the values above 9 as letters,
+ * A for 10 up to P for 25. Every grid gets one line with the puzzle and its
+ * solution like when streaming, the summary goes to the standard error
+ */
+int solve_grids()
+{
+    int cells = grid_order * grid_order * grid_order * grid_order;
+    FILE *in = (strequals(filename, "-")) ? stdin : fopen(filename, "r");
+    if (in == NULL)
+    {
+        printf("Could not open %s\n", filename);
+        return 1;
+    }
+
+    //a line holds a grid, optionally followed by a comma and its solution,
+    //the lines that don't are reported and skipped
+    int capacity = 1024;
+    int n = 0;
+    int invalid = 0;
+    int lineNumber = 0;
+    char **lines = (char **)malloc(capacity * sizeof(char *));
+    char *line = NULL;
+    size_t line_size = 0;
+    while (n < num_sudokus && getline(&line, &line_size, in) != -1)
+    {
+        lineNumber++;
+        int length = (int)strcspn(line, ",\r\n");
+        if (length == 0)
+            continue;
+        if (length != cells)
+        {
+            fprintf(stderr, "Line %d has %d cells but a %dx%d sudoku has %d\n", lineNumber, length,
+                    grid_order * grid_order, grid_order * grid_order, cells);
+            invalid++;
+            continue;
+        }
+        int bad = grid_find_invalid_char(grid_order, line);
+        if (bad >= 0)
+        {
+            fprintf(stderr, "Line %d has '%c' in cell %d, which is not a value of a %dx%d sudoku\n", lineNumber,
+                    line[bad], bad + 1, grid_order * grid_order, grid_order * grid_order);
+            invalid++;
+            continue;
+        }
+        if (n == capacity)
+        {
+            capacity *= 2;
+            lines = (char **)realloc(lines, capacity * sizeof(char *));
+        }
+        lines[n] = (char *)malloc(cells + 1);
+        memcpy(lines[n], line, cells);
+        lines[n++][cells] = '\0';
+    }
+    free(line);
+    if (in != stdin)
+        fclose(in);
+
+    int count = max(n, 1);
+    GridRun run;
+    run.lines = lines;
+    run.results = (GridResult *)malloc(count * sizeof(GridResult));
+    run.grids = (Grid *)malloc(num_threads * sizeof(Grid));
+
+    int64_t start = getTimeNs();
+    ThreadPool *pool = pool_start(num_threads, n, pool_default_chunk_size(num_threads, n), solve_grid_at, &run);
+    pool_wait(pool);
+    float totalTime = (float)((getTimeNs() - start) / 1e9);
+
+    int solved = 0;
+    int wrong = 0;
+    long long totalSteps = 0;
+    int64_t time = 0;
+    int solutions[3] = {0};
+    for (int i = 0; i < n; i++)
+    {
+        GridResult *res = &run.results[i];
+        if (print)
+        {
+            char *solution = (res->solution != NULL) ? res->solution : "";
+            if (count_limit)
+                printf("%s,%s,%d\n", lines[i], solution, res->solutions);
+            else
+                printf("%s,%s\n", lines[i], solution);
+        }
+        if (!res->verified)
+            fprintf(stderr, "The solution of %s is wrong\n", lines[i]);
+
+        solved += res->result == SUDOKU_SOLVED;
+        wrong += !res->verified;
+        totalSteps += res->steps;
+        time += res->elapsed;
+        solutions[min(res->solutions, 2)]++;
+        free(res->solution);
+        free(lines[i]);
+    }
+    free(lines);
+    free(run.results);
+    free(run.grids);
+
+    char timeBuff[40];
+    if (invalid > 0)
+        fprintf(stderr, "Skipped %d line%s that %s not a %dx%d sudoku\n", invalid, (invalid != 1) ? "s" : "",
+                (invalid != 1) ? "were" : "was", grid_order * grid_order, grid_order * grid_order);
+    fprintf(stderr, "Attempted to solve %d %dx%d sudoku%s\n", n, grid_order * grid_order, grid_order * grid_order,
+            (n != 1) ? "s" : "");
+    fprintf(stderr, "For %d of them a solution was found\n", solved);
+    fprintf(stderr, "%.2f%% of the sudokus were solved\n", 100 * (float)solved / count);
+    fprintf(stderr, "Average steps for solution %.0f\n", (float)totalSteps / count);
+    fprintf(stderr, "Average time for solution %s\n", format_duration_ns(time / count, timeBuff, 40));
+    print_uniqueness(stderr, solutions[1], solutions[2], solutions[0]);
+    fprintf(stderr, "Verified %d solution%s, %d %s wrong\n", solved, (solved != 1) ? "s" : "", wrong,
+            (wrong != 1) ? "were" : "was");
+    fprintf(stderr, "Total time: %s\n", format_time_seconds(totalTime, timeBuff, 40));
+
+    return wrong > 0 || invalid > 0;
+}
+
+/**
+ * This function solves the sudokus of the file the user asked for
+ */
+int solve_sudokus()
+{
+    //"-" is the standard input
+    if (strequals(filename, "-"))
+    {
+        return solve_sudoku_stream(stdin);
+    }
+
+    struct stat st;
+    if (stat(filename, &st) != 0)
+    {
+        printf("Could not open %s\n", filename);
+        return 1;
+    }
+
+    //pipes and devices can't be loaded as a whole, so they are streamed
+    if (!S_ISREG(st.st_mode))
+    {
+        FILE *in = fopen(filename, "r");
+        if (in == NULL)
+        {
+            printf("Could not open %s\n", filename);
+            return 1;
+        }
+        int ret = solve_sudoku_stream(in);
+        fclose(in);
+        return ret;
+    }
+
+    return solve_sudoku_file();
+}
+
+/**
+ * The entry point of the program
+ */
+int main(int argc, char *argv[])
+{
+    //handle the arguments and set the global variables
+    handle_args(argc, argv);
+
+    //the engines only solve the classic sudoku, the other orders have their own kernels
+    if (grid_order != 3)
+    {
+        if (grid_order < GRID_MIN_ORDER || grid_order > GRID_MAX_ORDER)
+        {
+            printf("The order must be between %d and %d\n", GRID_MIN_ORDER, GRID_MAX_ORDER);
+            return 1;
+        }
+        char *option = grid_unsupported_option();
+        if (option != NULL)
+        {
+            printf("%s only works on 9x9 sudokus and can't be used with --order %d\n", option, grid_order);
+            return 1;
+        }
+        return solve_grids();
+    }
+
+    //find the engine the user asked for
+    engine_register_defaults();
+    if (engine_name == NULL)
+    {
+        engine_name = (with_pencilmarks) ? "pencilmarks" : "backtracking";
+    }
+    engine = engine_find(engine_name);
+    if (engine == NULL)
+    {
+        //let the user know which engines there are
+        if (!strequals(engine_name, "list"))
+            printf("Unknown engine %s\n", engine_name);
+        printf("Engines:\n");
+        for (int i = 0; i < engine_get_count(); i++)
+        {
+            printf("  %-14s %s\n", engine_get(i)->name, engine_get(i)->description);
+        }
+        return !strequals(engine_name, "list");
+    }
+
+    if (generate_count > 0)
+    {
+        return generate_sudokus();
+    }
+
+    if (count_limit && engine->count_solutions == NULL)
+    {
+        printf("The %s engine can't count solutions\n", engine->name);
+        return 1;
+    }
+
+    //the members that race, a portfolio or the orientations of the engine
+    if (portfolio != NULL)
+    {
+        num_race_members = race_parse_portfolio((portfolio[0] != '\0') ? portfolio : RACE_DEFAULT_PORTFOLIO,
+                                                race_members);
+        if (num_race_members <= 0)
+        {
+            printf("Invalid portfolio %s, members are engine[:first|last][:least|most|lowest][:o0-o7] and only "
+                   "the pencilmarks and backtracking engines take the first, last, least, most and lowest rules\n",
+                   portfolio);
+            return 1;
+        }
+    }
+    else if (race_racers > 0)
+    {
+        num_race_members = race_orientations(engine, race_racers, race_members);
+    }
+
+    //the first member to finish stops the others, so they can't count
+    if (count_limit && num_race_members > 0)
+    {
+        printf("Racing can't count solutions\n");
+        return 1;
+    }
+
+    //only the parallel engine splits the search of a sudoku between threads,
+    //on its own or as a member of a race
+    if (search_threads > 0)
+    {
+        int splits = num_race_members == 0 && strcmp(engine->name, "parallel") == 0;
+        for (int k = 0; k < num_race_members; k++)
+        {
+            splits = splits || strcmp(race_members[k].engine->name, "parallel") == 0;
+        }
+        if (!splits)
+        {
+            printf("--search-threads only works with the parallel engine\n");
+            return 1;
+        }
+    }
+
+    //every worker has its own state of the engine, it is created once
+    EngineOptions options = {.print_history = print_history, .search_threads = search_threads};
+    engine_states = (void **)malloc(num_threads * sizeof(void *));
+    for (int i = 0; i < num_threads; i++)
+    {
+        engine_states[i] = engine->create(&options);
+    }
+
+    //find out which hardware events this machine can count, the workers open
+    //their own counters, if there are none the sudokus are solved without them
+    if (count_perf)
+    {
+        PerfCounters probe;
+        int available = perf_counters_open(&probe);
+        for (int e = 0; e < PERF_EVENTS; e++)
+        {
+            perf_available[e] = probe.fds[e] >= 0;
+        }
+        perf_counters_close(&probe);
+
+        if (available == 0)
+        {
+            fprintf(stderr, "Hardware counters are not available (is perf_event_paranoid too high or is this a "
+                            "virtual machine?), solving without them\n");
+            count_perf = 0;
+        }
+        else
+        {
+            perf_counters = (PerfCounters *)calloc(num_threads, sizeof(PerfCounters));
+        }
+    }
+
+    if (cache_capacity > 0)
+    {
+        solved_cache = create_solved_cache(cache_capacity);
+    }
+
+    if (num_race_members > 0)
+    {
+        races = (Race **)malloc(num_threads * sizeof(Race *));
+        for (int i = 0; i < num_threads; i++)
+        {
+            races[i] = create_race(race_members, num_race_members, &options);
+        }
+    }
+
+    int ret = solve_sudokus();
+
+    for (int i = 0; i < num_threads; i++)
+    {
+        engine->free(engine_states[i]);
+        if (perf_counters != NULL && perf_counters[i].opened)
+            perf_counters_close(&perf_counters[i]);
+    }
+    free(engine_states);
+    free(perf_counters);
+    for (int i = 0; races != NULL && i < num_threads; i++)
+    {
+        race_free(races[i]);
+    }
+    free(races);
+    if (solved_cache != NULL)
+        solved_cache_free(solved_cache);
+
+    return ret;
 }
@@ -3,35 +3,12 @@
 
 #define EMPTY_MASK 0x0
 
-/**
- * Returns an empty pencilmarks set. 
- * Allocated memory for the set itself and the stack itself
- * Set the mask so that no numbers are in the set
- */
-PSet *pencilmarks_set_create()
-{
-    PSet *ps = (PSet *)malloc(sizeof(PSet));
-    ps->mask = EMPTY_MASK;
-
-    return ps;
-}
-
-/**
- * Frees a set from memory 
- * Frees the stack and then the memory used by
- * the set itself
- */
-void pencilmarks_set_free(PSet *ps)
-{
-    free(ps);
-}
-
 /**
  * Returns true if a value is in the given set
  */
 int pencilmarks_set_contains(PSet *ps, int val)
 {
-    return get_bit(ps->mask, val);
+    return get_bit(*ps, val);
 }
 
 void pencilmarks_set_print_mask(int mask)
@@ -59,7 +36,7 @@ void pencilmarks_set_print_mask(int mask)
 
 void pencilmarks_set_print(PSet *ps)
 {
-    pencilmarks_set_print_mask(ps->mask);
+    pencilmarks_set_print_mask(*ps);
 }
 
 /**
@@ -68,7 +45,7 @@ void pencilmarks_set_print(PSet *ps)
  */
 int pencilmarks_set_is_subset(PSet *ps1, PSet *ps2)
 {
-    return (ps1->mask | ps2->mask) == ps1->mask;
+    return (*ps1 | *ps2) == *ps1;
 }
 
 /**
@@ -76,17 +53,17 @@ int pencilmarks_set_is_subset(PSet *ps1, PSet *ps2)
  */
 int pencilmarks_set_get_size(PSet *ps)
 {
-    return count_ones(ps->mask);
+    return count_ones(*ps);
 }
 
 int pencilmarks_set_get_min(PSet *ps)
 {
-    return trailing_zeros(ps->mask);
+    return trailing_zeros(*ps);
 }
 
 int pencilmarks_set_get_max(PSet *ps)
 {
-    return leading_zeros(ps->mask);
+    return leading_zeros(*ps);
 }
 
 /**
@@ -98,7 +75,7 @@ int pencilmarks_set_get_max(PSet *ps)
 int pencilmarks_set_add_pencilmark(PSet *ps, int val)
 {
     //set the ith bit to 1 to indicate that the value is in
-    set_bit(&(ps->mask), val, 1);
+    *ps |= (PSet)(1 << val);
 
     return 0;
 }
@@ -110,17 +87,8 @@ int pencilmarks_set_add_pencilmark(PSet *ps, int val)
  */
 int pencilmarks_set_remove_pencilmark(PSet *ps, int val)
 {
-    if (pencilmarks_set_contains(ps, val))
-    {
-        if (pencilmarks_set_get_size(ps) == 1)
-        {
-            ps->mask = EMPTY_MASK;
-        }
-        else
-        {
-            set_bit(&(ps->mask), val, 0);
-        }
-    }
+    //set the ith bit to 0, if it was already 0 nothing changes
+    *ps &= (PSet) ~(1 << val);
     return 0;
 }
 
@@ -130,7 +98,8 @@ int pencilmarks_set_remove_pencilmark(PSet *ps, int val)
 int pencilmarks_set_clear(PSet *ps)
 {
     //Set the mask to zero again
-    ps->mask = EMPTY_MASK;
+    *ps = EMPTY_MASK;
+    return 0;
 }
 
 /**
@@ -140,8 +109,8 @@ int pencilmarks_set_clear(PSet *ps)
 int pencilmarks_set_pop_value(PSet *ps)
 {
 
-    int val = trailing_zeros(ps->mask);
-    // ps->mask &= ~(1 << val);
+    int val = trailing_zeros(*ps);
+    // *ps &= ~(1 << val);
     pencilmarks_set_remove_pencilmark(ps, val);
 
     //and return the value
@@ -154,7 +123,7 @@ int pencilmarks_set_pop_value(PSet *ps)
  */
 int pencilmarks_set_equals(PSet *ps1, PSet *ps2)
 {
-    return ps1->mask == ps2->mask;
+    return *ps1 == *ps2;
 }
 
 /**
@@ -164,17 +133,15 @@ int pencilmarks_set_equals(PSet *ps1, PSet *ps2)
 int pencilmarks_set_intersection(PSet *ps1, PSet *ps2)
 {
 
-    return ps1->mask & ps2->mask;
+    return *ps1 & *ps2;
 }
 
 /**
  * Returns a new set that contains the elements
  * that are only in ps1 and not in ps2
- * THIS FUNCTION ALLOCATES MEMORY THAT NEEDS TO BE 
- * FREED LATER
  */
 int pencilmarks_set_difference(PSet *to_keep, PSet *other)
 {
 
-    return to_keep->mask & ~other->mask;
+    return *to_keep & ~*other;
 }
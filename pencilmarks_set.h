@@ -1,18 +1,22 @@
 #include "stack.h"
+#include <stdint.h>
 
 #define ALREADY_SET -10
 #define CANNOT_DELETE_UNSET -11
 #define SET_EMPTY -1
 
-typedef struct _PencilmarksSet
-{
-    int mask;
-} PencilmarksSet;
+//the set that contains every value in [1,...,9]
+#define ALL_PENCILMARKS 0x3fe
+
+/**
+ * A pencilmarks set is a bitmask where bit i is set iff the value i
+ * is in the set. Values range from 1 to 9 so 16 bits are enough. It is
+ * held by value inside the sudoku so it never needs to be allocated
+ */
+typedef uint16_t PencilmarksSet;
 
 typedef PencilmarksSet PSet;
 
-PSet *pencilmarks_set_create();
-void pencilmarks_set_free(PSet *ps);
 int pencilmarks_set_contains(PSet *ps, int val);
 void pencilmarks_set_print_mask(int mask);
 void pencilmarks_set_print(PSet *ps);
@@ -0,0 +1,131 @@
+#include "perf.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/**
+ * Hardware performance counters through the perf_event_open system call.
+ * The counters only count the thread that opened them and only in user space,
+ * so they can be used without special privileges when perf_event_paranoid
+ * allows it. When the kernel or the machine doesn't support an event (for
+ * example inside a virtual machine) its value is PERF_UNAVAILABLE.
+ */
+
+const char *PERF_EVENT_NAMES[PERF_EVENTS] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+/**
+ * This function fills in the type and config of an event for perf_event_open
+ */
+static void perf_event_config(int event, struct perf_event_attr *attr)
+{
+    uint32_t type;
+    uint64_t config;
+
+    switch (event)
+    {
+    case PERF_CYCLES:
+        type = PERF_TYPE_HARDWARE;
+        config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_INSTRUCTIONS:
+        type = PERF_TYPE_HARDWARE;
+        config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_L1D_MISSES:
+        type = PERF_TYPE_HW_CACHE;
+        config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case PERF_LLC_MISSES:
+        type = PERF_TYPE_HARDWARE;
+        config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    default:
+        type = PERF_TYPE_HARDWARE;
+        config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    }
+
+    attr->type = type;
+    attr->config = config;
+}
+
+/**
+ * This function opens the counters for the calling thread, they start
+ * disabled. Returns how many events can be counted
+ */
+int perf_counters_open(PerfCounters *pc)
+{
+    pc->available = 0;
+    pc->opened = 1;
+
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        perf_event_config(e, &attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        //this thread, on any cpu
+        pc->fds[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (pc->fds[e] >= 0)
+            pc->available++;
+    }
+
+    return pc->available;
+}
+
+/**
+ * This function resets the counters and starts counting
+ */
+void perf_counters_start(PerfCounters *pc)
+{
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (pc->fds[e] < 0)
+            continue;
+        ioctl(pc->fds[e], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pc->fds[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+/**
+ * This function stops counting and writes the value of every event
+ */
+void perf_counters_stop(PerfCounters *pc, int64_t *values)
+{
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (pc->fds[e] >= 0)
+            ioctl(pc->fds[e], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        uint64_t count;
+        if (pc->fds[e] >= 0 && read(pc->fds[e], &count, sizeof(count)) == sizeof(count))
+            values[e] = (int64_t)count;
+        else
+            values[e] = PERF_UNAVAILABLE;
+    }
+}
+
+/**
+ * This function closes the counters
+ */
+void perf_counters_close(PerfCounters *pc)
+{
+    for (int e = 0; e < PERF_EVENTS; e++)
+    {
+        if (pc->fds[e] >= 0)
+            close(pc->fds[e]);
+        pc->fds[e] = -1;
+    }
+    pc->available = 0;
+    pc->opened = 0;
+}
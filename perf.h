@@ -0,0 +1,41 @@
+#if !defined(PERF_H)
+#define PERF_H
+
+#include <stdint.h>
+
+/**
+ * The hardware events that are counted around every solve
+ */
+typedef enum _PerfEvent
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_EVENTS
+} PerfEvent;
+
+//the value of an event that can't be counted
+#define PERF_UNAVAILABLE -1
+
+extern const char *PERF_EVENT_NAMES[PERF_EVENTS];
+
+/**
+ * The counters of one thread. Every event has its own file descriptor so that
+ * the events the machine supports are counted even if some others are not
+ */
+typedef struct _PerfCounters
+{
+    int fds[PERF_EVENTS];
+    //how many of the events can be counted
+    int available;
+    int opened;
+} PerfCounters;
+
+int perf_counters_open(PerfCounters *pc);
+void perf_counters_start(PerfCounters *pc);
+void perf_counters_stop(PerfCounters *pc, int64_t *values);
+void perf_counters_close(PerfCounters *pc);
+
+#endif // PERF_H
@@ -0,0 +1,164 @@
+#include "pool.h"
+#include <stdlib.h>
+
+/**
+ * A pool of worker threads that runs a task for every index of a range.
+ * The range is split in chunks of consecutive indeces. The chunks are dealt
+ * to the workers round robin, so that all the workers start at the beginning
+ * of the range and the results become available roughly in order. Every
+ * worker runs the chunks of its own deque from the lowest to the highest
+ * and when it runs out of chunks it steals the highest chunk of another
+ * worker. That way a worker that got hard puzzles doesn't hold everyone back.
+ */
+
+typedef struct _PoolWorker
+{
+    ThreadPool *pool;
+    int id;
+} PoolWorker;
+
+/**
+ * Takes the lowest chunk from the deque of a worker, returns -1 if it is empty
+ */
+static int pool_take(PoolDeque *d)
+{
+    int chunk = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom)
+    {
+        chunk = d->chunks[d->top++];
+    }
+    pthread_mutex_unlock(&d->lock);
+    return chunk;
+}
+
+/**
+ * Steals the highest chunk from the deque of a worker, returns -1 if it is empty
+ */
+static int pool_steal(PoolDeque *d)
+{
+    int chunk = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom)
+    {
+        chunk = d->chunks[--d->bottom];
+    }
+    pthread_mutex_unlock(&d->lock);
+    return chunk;
+}
+
+/**
+ * The loop of every worker thread
+ */
+static void *pool_worker_run(void *data)
+{
+    PoolWorker *w = (PoolWorker *)data;
+    ThreadPool *p = w->pool;
+
+    while (1)
+    {
+        //first look at our own chunks
+        int chunk = pool_take(&p->deques[w->id]);
+
+        //and if there are none left try to steal from the others
+        for (int i = 1; chunk < 0 && i < p->num_threads; i++)
+        {
+            chunk = pool_steal(&p->deques[(w->id + i) % p->num_threads]);
+        }
+
+        //nobody has chunks left, we are done
+        if (chunk < 0)
+            break;
+
+        //run the task for every index in the chunk
+        int begin = chunk * p->chunk_size;
+        int end = begin + p->chunk_size;
+        if (end > p->num_tasks)
+            end = p->num_tasks;
+        for (int i = begin; i < end; i++)
+        {
+            p->task(p->arg, w->id, i);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns a chunk size so that every worker gets a few chunks to begin with
+ * and there is something left to steal
+ */
+int pool_default_chunk_size(int num_threads, int num_tasks)
+{
+    int chunk_size = num_tasks / (num_threads * 8);
+    if (chunk_size > 64)
+        chunk_size = 64;
+    if (chunk_size < 1)
+        chunk_size = 1;
+    return chunk_size;
+}
+
+/**
+ * Starts num_threads workers that run the task for every index in [0, num_tasks).
+ * The function returns immediatelly, pool_wait needs to be called to wait for
+ * the workers and free the pool
+ */
+ThreadPool *pool_start(int num_threads, int num_tasks, int chunk_size, PoolTask task, void *arg)
+{
+    ThreadPool *p = (ThreadPool *)malloc(sizeof(ThreadPool));
+    p->num_threads = num_threads;
+    p->num_tasks = num_tasks;
+    p->chunk_size = chunk_size;
+    p->task = task;
+    p->arg = arg;
+
+    int num_chunks = (num_tasks + chunk_size - 1) / chunk_size;
+
+    //deal the chunks to the workers round robin
+    p->deques = (PoolDeque *)aligned_alloc(POOL_CACHE_LINE, num_threads * sizeof(PoolDeque));
+    for (int i = 0; i < num_threads; i++)
+    {
+        PoolDeque *d = &p->deques[i];
+        pthread_mutex_init(&d->lock, NULL);
+        d->chunks = (int *)malloc((num_chunks / num_threads + 1) * sizeof(int));
+        d->top = 0;
+        d->bottom = 0;
+        for (int c = i; c < num_chunks; c += num_threads)
+        {
+            d->chunks[d->bottom++] = c;
+        }
+    }
+
+    //and start the workers
+    p->threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    p->workers = (PoolWorker *)malloc(num_threads * sizeof(PoolWorker));
+    for (int i = 0; i < num_threads; i++)
+    {
+        p->workers[i].pool = p;
+        p->workers[i].id = i;
+        pthread_create(&p->threads[i], NULL, pool_worker_run, &p->workers[i]);
+    }
+
+    return p;
+}
+
+/**
+ * Waits until every task of the pool has run and frees the pool
+ */
+void pool_wait(ThreadPool *p)
+{
+    for (int i = 0; i < p->num_threads; i++)
+    {
+        pthread_join(p->threads[i], NULL);
+    }
+
+    for (int i = 0; i < p->num_threads; i++)
+    {
+        pthread_mutex_destroy(&p->deques[i].lock);
+        free(p->deques[i].chunks);
+    }
+    free(p->deques);
+    free(p->threads);
+    free(p->workers);
+    free(p);
+}
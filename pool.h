@@ -0,0 +1,43 @@
+#if !defined(POOL_H)
+#define POOL_H
+
+#include <pthread.h>
+
+#define POOL_CACHE_LINE 64
+
+/**
+ * A task of the pool. It is called once for every index in [0, num_tasks)
+ * with the argument given to the pool and the id of the worker that runs it
+ */
+typedef void (*PoolTask)(void *arg, int worker, int index);
+
+/**
+ * The deque of chunks of a worker. The owner takes chunks from the top,
+ * other workers steal chunks from the bottom
+ */
+typedef struct _PoolDeque
+{
+    pthread_mutex_t lock;
+    int top;
+    int bottom;
+    int *chunks;
+} __attribute__((aligned(POOL_CACHE_LINE))) PoolDeque;
+
+typedef struct _ThreadPool
+{
+    int num_threads;
+    int num_tasks;
+    int chunk_size;
+    PoolTask task;
+    void *arg;
+
+    PoolDeque *deques;
+    pthread_t *threads;
+    struct _PoolWorker *workers;
+} ThreadPool;
+
+ThreadPool *pool_start(int num_threads, int num_tasks, int chunk_size, PoolTask task, void *arg);
+void pool_wait(ThreadPool *p);
+int pool_default_chunk_size(int num_threads, int num_tasks);
+
+#endif // POOL_H
@@ -0,0 +1,319 @@
+#include "race.h"
+#include "utils.h"
+
+/**
+ * Racing solvers on the same sudoku. The order in which an engine picks cells
+ * and tries values depends on its rules, on where the givens are and on what
+ * digits they have, so the same sudoku can take a few steps with one member
+ * and millions with another. Solving with several members at once and keeping
+ * the first one that finishes cuts off that tail. The members are either
+ * orientations of the same engine or a portfolio of different configurations.
+ * The engines check the cancel flag of the race while they search, so the
+ * others stop soon after.
+ */
+
+#define RACE_SAME {0, 1, 2, 3, 4, 5, 6, 7, 8}
+#define RACE_REVERSED {8, 7, 6, 5, 4, 3, 2, 1, 0}
+#define RACE_DIGITS {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}
+#define RACE_DIGITS_REVERSED {0, 9, 8, 7, 6, 5, 4, 3, 2, 1}
+
+/**
+ * The orientations in the order they join the race: the sudoku itself, turned
+ * around, transposed on both diagonals, then with the digits reversed, which
+ * reverses the order the values are tried in, and turned a quarter
+ */
+const SudokuTransform RACE_ORIENTATIONS[RACE_MAX_RACERS] = {
+    {0, RACE_SAME, RACE_SAME, RACE_DIGITS, RACE_DIGITS},
+    {0, RACE_REVERSED, RACE_REVERSED, RACE_DIGITS, RACE_DIGITS},
+    {1, RACE_SAME, RACE_SAME, RACE_DIGITS, RACE_DIGITS},
+    {1, RACE_REVERSED, RACE_REVERSED, RACE_DIGITS, RACE_DIGITS},
+    {0, RACE_SAME, RACE_SAME, RACE_DIGITS_REVERSED, RACE_DIGITS_REVERSED},
+    {0, RACE_REVERSED, RACE_REVERSED, RACE_DIGITS_REVERSED, RACE_DIGITS_REVERSED},
+    {1, RACE_SAME, RACE_REVERSED, RACE_DIGITS, RACE_DIGITS},
+    {1, RACE_REVERSED, RACE_SAME, RACE_DIGITS_REVERSED, RACE_DIGITS_REVERSED},
+};
+
+/**
+ * This function returns whether an engine reads the cell and value rules,
+ * only the engines built on sudoku.c do
+ */
+static int race_engine_has_rules(const SolverEngine *engine)
+{
+    return strcmp(engine->name, "pencilmarks") == 0 || strcmp(engine->name, "backtracking") == 0;
+}
+
+/**
+ * This function reads a portfolio, a comma separated list of members, see
+ * RaceMember. Returns how many members there are, or -1 if one of them is
+ * not valid, which includes rules for an engine that ignores them, since
+ * that member would race exactly like the engine without them
+ */
+int race_parse_portfolio(const char *portfolio, RaceMember *members)
+{
+    int count = 0;
+    const char *p = portfolio;
+    while (*p != '\0')
+    {
+        size_t length = strcspn(p, ",");
+        if (count == RACE_MAX_RACERS || length == 0 || length >= RACE_NAME_LENGTH)
+            return -1;
+
+        RaceMember *m = &members[count++];
+        memcpy(m->name, p, length);
+        m->name[length] = '\0';
+        m->cell_rule = SUDOKU_CELL_FIRST_FEWEST;
+        m->value_rule = SUDOKU_VALUE_LEAST_FREQUENT;
+        m->orientation = 0;
+
+        //the engine comes first and the options follow it
+        char buff[RACE_NAME_LENGTH];
+        strcpy(buff, m->name);
+        char *option = strchr(buff, ':');
+        if (option != NULL)
+            *option++ = '\0';
+        m->engine = engine_find(buff);
+        if (m->engine == NULL)
+            return -1;
+
+        while (option != NULL)
+        {
+            char *next = strchr(option, ':');
+            if (next != NULL)
+                *next++ = '\0';
+
+            int is_rule = strcmp(option, "first") == 0 || strcmp(option, "last") == 0 ||
+                          strcmp(option, "least") == 0 || strcmp(option, "most") == 0 || strcmp(option, "lowest") == 0;
+            if (is_rule && !race_engine_has_rules(m->engine))
+                return -1;
+
+            if (strcmp(option, "first") == 0)
+                m->cell_rule = SUDOKU_CELL_FIRST_FEWEST;
+            else if (strcmp(option, "last") == 0)
+                m->cell_rule = SUDOKU_CELL_LAST_FEWEST;
+            else if (strcmp(option, "least") == 0)
+                m->value_rule = SUDOKU_VALUE_LEAST_FREQUENT;
+            else if (strcmp(option, "most") == 0)
+                m->value_rule = SUDOKU_VALUE_MOST_FREQUENT;
+            else if (strcmp(option, "lowest") == 0)
+                m->value_rule = SUDOKU_VALUE_LOWEST;
+            else if (option[0] == 'o' && option[1] >= '0' && option[1] < '0' + RACE_MAX_RACERS && option[2] == '\0')
+                m->orientation = option[1] - '0';
+            else
+                return -1;
+
+            option = next;
+        }
+
+        p += length;
+        if (*p == ',')
+            p++;
+    }
+    return count;
+}
+
+/**
+ * This function writes the members that race the orientations of a sudoku
+ * with the same engine. Returns how many there are
+ */
+int race_orientations(const SolverEngine *engine, int num_racers, RaceMember *members)
+{
+    num_racers = (num_racers < 1) ? 1 : (num_racers > RACE_MAX_RACERS) ? RACE_MAX_RACERS : num_racers;
+    for (int k = 0; k < num_racers; k++)
+    {
+        RaceMember *m = &members[k];
+        snprintf(m->name, RACE_NAME_LENGTH, "%s:o%d", engine->name, k);
+        m->engine = engine;
+        m->cell_rule = SUDOKU_CELL_FIRST_FEWEST;
+        m->value_rule = SUDOKU_VALUE_LEAST_FREQUENT;
+        m->orientation = k;
+    }
+    return num_racers;
+}
+
+/**
+ * This function solves the sudoku of a racer. The first racer that
+ * decides the sudoku wins and cancels the others, a racer that was
+ * cancelled leaves it undecided
+ */
+static void race_run(Race *r, int k)
+{
+    void *state = r->states[k];
+    const SolverEngine *engine = r->members[k].engine;
+    engine->load_from_char(state, r->sudokus[k]);
+    engine->solve(state, &r->results[k]);
+
+    pthread_mutex_lock(&r->lock);
+    if (r->winner < 0 && r->results[k] != SUDOKU_UNDECIDED)
+    {
+        r->winner = k;
+        r->win_time = getTimeNs();
+        atomic_store_explicit(&r->cancel, 1, memory_order_relaxed);
+    }
+    r->finished++;
+    pthread_cond_signal(&r->done);
+    pthread_mutex_unlock(&r->lock);
+}
+
+/**
+ * The thread of a racer, it races every sudoku until the race is freed
+ */
+static void *race_thread(void *arg)
+{
+    RaceRacer *racer = (RaceRacer *)arg;
+    Race *r = racer->race;
+    int seen = 0;
+
+    while (1)
+    {
+        pthread_mutex_lock(&r->lock);
+        while (r->generation == seen && !r->quit)
+        {
+            pthread_cond_wait(&r->start, &r->lock);
+        }
+        int quit = r->quit;
+        seen = r->generation;
+        pthread_mutex_unlock(&r->lock);
+
+        if (quit)
+            break;
+        race_run(r, racer->id);
+    }
+    return NULL;
+}
+
+/**
+ * This function creates a race between members, the engine of every racer is
+ * created with the options, the rules of its member and the cancel flag of
+ * the race. Only the first member writes the history, if it is written at all
+ */
+Race *create_race(RaceMember *members, int num_racers, EngineOptions *options)
+{
+    Race *r = (Race *)malloc(sizeof(Race));
+    r->num_racers = (num_racers < 1) ? 1 : (num_racers > RACE_MAX_RACERS) ? RACE_MAX_RACERS : num_racers;
+    memcpy(r->members, members, r->num_racers * sizeof(RaceMember));
+    r->generation = 0;
+    r->finished = 0;
+    r->quit = 0;
+    atomic_init(&r->cancel, 0);
+    r->winner = -1;
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->start, NULL);
+    pthread_cond_init(&r->done, NULL);
+
+    for (int k = 0; k < r->num_racers; k++)
+    {
+        EngineOptions racer_options = *options;
+        racer_options.print_history = options->print_history && k == 0;
+        racer_options.cell_rule = members[k].cell_rule;
+        racer_options.value_rule = members[k].value_rule;
+        racer_options.cancel = &r->cancel;
+        r->states[k] = members[k].engine->create(&racer_options);
+    }
+
+    //the caller races as the first member
+    for (int k = 1; k < r->num_racers; k++)
+    {
+        r->racers[k].race = r;
+        r->racers[k].id = k;
+        pthread_create(&r->threads[k], NULL, race_thread, &r->racers[k]);
+    }
+    return r;
+}
+
+/**
+ * This function stops the threads of the racers and frees the race
+ */
+void race_free(Race *r)
+{
+    pthread_mutex_lock(&r->lock);
+    r->quit = 1;
+    pthread_cond_broadcast(&r->start);
+    pthread_mutex_unlock(&r->lock);
+
+    for (int k = 1; k < r->num_racers; k++)
+    {
+        pthread_join(r->threads[k], NULL);
+    }
+    for (int k = 0; k < r->num_racers; k++)
+    {
+        r->members[k].engine->free(r->states[k]);
+    }
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->start);
+    pthread_cond_destroy(&r->done);
+    free(r);
+}
+
+/**
+ * This function races the members on a sudoku string. The result and the
+ * counters are the winner's, the values are its solution turned back to
+ * the orientation of the sudoku. The time until the winner starts counts as
+ * parsing and the time until the others stop counts as teardown. Returns the
+ * orientation that won
+ */
+int race_solve(Race *r, char *sudoku, int *result, uint8_t *values, EngineCounters *counters)
+{
+    int64_t start = getTimeNs();
+
+    uint8_t givens[SUDOKU_CELLS];
+    uint8_t oriented[SUDOKU_CELLS];
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        char c = sudoku[i];
+        givens[i] = (c >= '1' && c <= '9') ? (uint8_t)(c - '0') : 0;
+    }
+    for (int k = 0; k < r->num_racers; k++)
+    {
+        symmetry_to_canonical(&RACE_ORIENTATIONS[r->members[k].orientation], givens, oriented);
+        for (int i = 0; i < SUDOKU_CELLS; i++)
+        {
+            r->sudokus[k][i] = (char)('0' + oriented[i]);
+        }
+    }
+
+    pthread_mutex_lock(&r->lock);
+    atomic_store_explicit(&r->cancel, 0, memory_order_relaxed);
+    r->winner = -1;
+    r->finished = 0;
+    r->generation++;
+    pthread_cond_broadcast(&r->start);
+    pthread_mutex_unlock(&r->lock);
+
+    race_run(r, 0);
+
+    pthread_mutex_lock(&r->lock);
+    while (r->finished < r->num_racers)
+    {
+        pthread_cond_wait(&r->done, &r->lock);
+    }
+    pthread_mutex_unlock(&r->lock);
+    int64_t end = getTimeNs();
+
+    //an engine that leaves the sudoku undecided on its own has no winner
+    int winner = (r->winner >= 0) ? r->winner : 0;
+    int64_t win_time = (r->winner >= 0) ? r->win_time : end;
+    const RaceMember *m = &r->members[winner];
+    void *state = r->states[winner];
+
+    *result = r->results[winner];
+    m->engine->get_values(state, oriented);
+    symmetry_from_canonical(&RACE_ORIENTATIONS[m->orientation], oriented, values);
+    m->engine->get_counters(state, counters);
+
+    for (int k = 0; k < r->num_racers; k++)
+    {
+        if (r->members[k].engine->release != NULL)
+            r->members[k].engine->release(r->states[k]);
+    }
+
+    int64_t phases = 0;
+    for (int p = 0; p < ENGINE_PHASES; p++)
+    {
+        phases += counters->phase_ns[p];
+    }
+    int64_t waiting = win_time - start - phases;
+    counters->phase_ns[ENGINE_PHASE_PARSE] += (waiting > 0) ? waiting : 0;
+    counters->phase_ns[ENGINE_PHASE_TEARDOWN] += end - win_time;
+
+    return winner;
+}
@@ -0,0 +1,83 @@
+#if !defined(RACE_H)
+#define RACE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "engine.h"
+#include "symmetry.h"
+
+//how many members a race can have
+#define RACE_MAX_RACERS 8
+#define RACE_NAME_LENGTH 64
+
+//the portfolio when the user doesn't give one
+#define RACE_DEFAULT_PORTFOLIO "bitboard,dlx,pencilmarks,pencilmarks:last:most,backtracking:lowest:o1"
+
+/**
+ * A configuration of a solver that takes part in a race. It is written as
+ * engine[:option...], the options are the SUDOKU_CELL_* rule (first, last),
+ * the SUDOKU_VALUE_* rule (least, most, lowest) and the orientation (o0 to o7).
+ * Only the pencilmarks and backtracking engines take the rules
+ */
+typedef struct _RaceMember
+{
+    char name[RACE_NAME_LENGTH];
+    const SolverEngine *engine;
+    int cell_rule;
+    int value_rule;
+    //the index of the orientation in RACE_ORIENTATIONS
+    int orientation;
+} RaceMember;
+
+struct _Race;
+
+/**
+ * What the thread of a racer needs to know
+ */
+typedef struct _RaceRacer
+{
+    struct _Race *race;
+    int id;
+} RaceRacer;
+
+/**
+ * A team of threads that solve the same sudoku with different members at
+ * once. The caller races as the first member, the others have a thread each
+ * that waits for the next sudoku. The first racer to finish cancels the others
+ */
+typedef struct _Race
+{
+    int num_racers;
+    RaceMember members[RACE_MAX_RACERS];
+    //the state of the engine of every racer
+    void *states[RACE_MAX_RACERS];
+    pthread_t threads[RACE_MAX_RACERS];
+    RaceRacer racers[RACE_MAX_RACERS];
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    //counts the sudokus, a racer starts when it sees a new one
+    int generation;
+    int finished;
+    int quit;
+    //set by the winner, the engines of the others give up when they see it
+    atomic_int cancel;
+    int winner;
+    int64_t win_time;
+
+    //the orientation every racer solves, as a string
+    char sudokus[RACE_MAX_RACERS][SUDOKU_CELLS];
+    int results[RACE_MAX_RACERS];
+} Race;
+
+extern const SudokuTransform RACE_ORIENTATIONS[RACE_MAX_RACERS];
+
+int race_parse_portfolio(const char *portfolio, RaceMember *members);
+int race_orientations(const SolverEngine *engine, int num_racers, RaceMember *members);
+Race *create_race(RaceMember *members, int num_racers, EngineOptions *options);
+void race_free(Race *r);
+int race_solve(Race *r, char *sudoku, int *result, uint8_t *values, EngineCounters *counters);
+
+#endif // RACE_H
@@ -0,0 +1,549 @@
+#include "rate.h"
+#include "sudoku.h"
+#include "bitboard.h"
+
+/**
+ * A rating engine that solves with logic only, the way a person would. Every
+ * round it looks for the cheapest technique that makes progress and applies
+ * every instance of it that it finds, the instances are all found on the same
+ * candidates before any of them is applied. That makes every round a function
+ * of the candidates alone, so relabeling the digits, transposing or swapping
+ * rows and columns changes nothing, and the rating is the same for every
+ * orientation of a sudoku.
+ *
+ * The score of a sudoku is the score of the hardest technique it needed. If
+ * the techniques are not enough, the rest of the sudoku is searched with the
+ * bitboard engine and the score is the one of RATE_SEARCH.
+ */
+
+const char *RATE_TECHNIQUE_NAMES[RATE_TECHNIQUES] = {
+    "hidden_single", "naked_single", "locked_candidates", "naked_pair", "x_wing", "hidden_pair",
+    "naked_triple", "swordfish", "hidden_triple", "naked_quad", "hidden_quad", "search"};
+
+const int RATE_TECHNIQUE_SCORES[RATE_TECHNIQUES] = {15, 23, 28, 30, 32, 34, 36, 38, 40, 50, 54, 100};
+
+//the candidates of a cell that can have any value
+#define RATE_ALL_DIGITS 0x3fe
+
+/**
+ * The changes that a technique found in a round. They are applied
+ * after the technique has looked at every house
+ */
+typedef struct _RateChanges
+{
+    //the value to fill in every cell, 0 for none
+    uint8_t place[SUDOKU_CELLS];
+    //the candidates to remove from every cell
+    uint16_t remove[SUDOKU_CELLS];
+    //whether anything changes
+    int any;
+    //whether the technique found that the sudoku has no solution
+    int conflict;
+} RateChanges;
+
+/**
+ * This function returns the next combination of the same number of items
+ * after a set (Gosper's hack), the sets go up to 1 << num_items
+ */
+static inline int rate_next_combination(int set)
+{
+    int lowest = set & -set;
+    int ripple = set + lowest;
+    return (((ripple ^ set) >> 2) / lowest) | ripple;
+}
+
+/**
+ * This function fills in a value in an empty cell and removes it
+ * from the candidates of the cell's peers
+ */
+static void rate_place(Rating *r, int index, int value)
+{
+    r->values[index] = (uint8_t)value;
+    r->candidates[index] = 0;
+    r->num_empty--;
+
+    uint16_t bit = (uint16_t)(1 << value);
+    for (int i = 0; i < SUDOKU_NEIGHBORS; i++)
+    {
+        r->candidates[NEIGHBORS[index][i]] &= ~bit;
+    }
+}
+
+/**
+ * This function loads a sudoku from a string, every char that is not
+ * a digit from 1 to 9 is an empty cell
+ */
+void rate_load_from_char(Rating *r, char *data)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        r->values[i] = 0;
+        r->candidates[i] = RATE_ALL_DIGITS;
+    }
+    r->num_empty = SUDOKU_CELLS;
+    r->invalid = 0;
+    r->score = 0;
+    r->hardest = -1;
+    memset(r->uses, 0, sizeof(r->uses));
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        char c = data[i];
+        if (c < '1' || c > '9')
+            continue;
+
+        //a peer with the same value took it away
+        int value = c - '0';
+        if (!(r->candidates[i] & (1 << value)))
+            r->invalid = 1;
+        rate_place(r, i, value);
+    }
+}
+
+/**
+ * This function removes candidates from a cell, if it has them
+ */
+static inline void rate_eliminate(Rating *r, RateChanges *c, int index, int bits)
+{
+    bits &= r->candidates[index];
+    if (bits)
+    {
+        c->remove[index] |= (uint16_t)bits;
+        c->any = 1;
+    }
+}
+
+/**
+ * This function fills in a value in a cell, a cell that would get
+ * two different values means the sudoku has no solution
+ */
+static inline void rate_fill(RateChanges *c, int index, int value)
+{
+    if (c->place[index] != 0 && c->place[index] != value)
+        c->conflict = 1;
+    c->place[index] = (uint8_t)value;
+    c->any = 1;
+}
+
+/**
+ * This function returns false if an empty cell has no candidates or a
+ * digit has nowhere to go in a house
+ */
+static int rate_is_consistent(Rating *r)
+{
+    for (int h = 0; h < 27; h++)
+    {
+        int seen = 0;
+        for (int i = 0; i < 9; i++)
+        {
+            int index = HOUSES[h][i];
+            if (r->values[index] == 0 && r->candidates[index] == 0)
+                return 0;
+            seen |= r->candidates[index] | (1 << r->values[index]);
+        }
+        if ((seen & RATE_ALL_DIGITS) != RATE_ALL_DIGITS)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Empty cells that have a single candidate
+ */
+static void rate_naked_singles(Rating *r, RateChanges *c)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        if (r->values[i] == 0 && is_power_of_two(r->candidates[i]))
+            rate_fill(c, i, trailing_zeros(r->candidates[i]));
+    }
+}
+
+/**
+ * Digits that fit in a single cell of a house
+ */
+static void rate_hidden_singles(Rating *r, RateChanges *c)
+{
+    for (int h = 0; h < 27; h++)
+    {
+        //the digits that are candidates of at least one and at least two cells
+        int once = 0;
+        int twice = 0;
+        for (int i = 0; i < 9; i++)
+        {
+            int m = r->candidates[HOUSES[h][i]];
+            twice |= once & m;
+            once |= m;
+        }
+
+        int single = once & ~twice;
+        for (int i = 0; i < 9 && single; i++)
+        {
+            int index = HOUSES[h][i];
+            int m = r->candidates[index] & single;
+            if (m)
+            {
+                rate_fill(c, index, trailing_zeros(m));
+                single &= ~m;
+            }
+        }
+    }
+}
+
+/**
+ * The digits of the cells where a row or column meets a box. A digit that the
+ * rest of the box doesn't have must be in the line, so the rest of the line
+ * loses it (pointing), and a digit that the rest of the line doesn't have must
+ * be in the box, so the rest of the box loses it (claiming)
+ */
+static void rate_locked_candidates(Rating *r, RateChanges *c)
+{
+    //the rows and then the columns
+    for (int line = 0; line < 18; line++)
+    {
+        const uint8_t *cells = HOUSES[line];
+        for (int part = 0; part < 3; part++)
+        {
+            int box = CELL_BOX[cells[part * 3]];
+            int inter = 0;
+            int line_rest = 0;
+            int box_rest = 0;
+            for (int i = 0; i < 9; i++)
+            {
+                int m = r->candidates[cells[i]];
+                if (i / 3 == part)
+                    inter |= m;
+                else
+                    line_rest |= m;
+            }
+            for (int i = 0; i < 9; i++)
+            {
+                int index = HOUSES[BOX_HOUSE(box)][i];
+                if (index != cells[part * 3] && index != cells[part * 3 + 1] && index != cells[part * 3 + 2])
+                    box_rest |= r->candidates[index];
+            }
+
+            int pointing = inter & ~box_rest;
+            int claiming = inter & ~line_rest;
+            for (int i = 0; i < 9 && pointing; i++)
+            {
+                if (i / 3 != part)
+                    rate_eliminate(r, c, cells[i], pointing);
+            }
+            for (int i = 0; i < 9 && claiming; i++)
+            {
+                int index = HOUSES[BOX_HOUSE(box)][i];
+                if (index != cells[part * 3] && index != cells[part * 3 + 1] && index != cells[part * 3 + 2])
+                    rate_eliminate(r, c, index, claiming);
+            }
+        }
+    }
+}
+
+/**
+ * Size cells of a house whose candidates are size digits, the other
+ * cells of the house can't have these digits
+ */
+static void rate_naked_subsets(Rating *r, RateChanges *c, int size)
+{
+    for (int h = 0; h < 27; h++)
+    {
+        int cells[9];
+        int num_cells = 0;
+        for (int i = 0; i < 9; i++)
+        {
+            if (r->values[HOUSES[h][i]] == 0)
+                cells[num_cells++] = HOUSES[h][i];
+        }
+        if (num_cells <= size)
+            continue;
+
+        for (int set = (1 << size) - 1; set < (1 << num_cells); set = rate_next_combination(set))
+        {
+            int digits = 0;
+            for (int i = 0; i < num_cells; i++)
+            {
+                if (set & (1 << i))
+                    digits |= r->candidates[cells[i]];
+            }
+            if (count_ones(digits) != size)
+                continue;
+
+            for (int i = 0; i < num_cells; i++)
+            {
+                if (!(set & (1 << i)))
+                    rate_eliminate(r, c, cells[i], digits);
+            }
+        }
+    }
+}
+
+/**
+ * Size digits that only fit in the same size cells of a house, these
+ * cells can't have any other digit
+ */
+static void rate_hidden_subsets(Rating *r, RateChanges *c, int size)
+{
+    for (int h = 0; h < 27; h++)
+    {
+        //the cells of the house where every digit that is not placed fits
+        int digits[9];
+        int positions[9];
+        int num_digits = 0;
+        int num_empty = 0;
+        for (int d = 1; d <= 9; d++)
+        {
+            int where = 0;
+            for (int i = 0; i < 9; i++)
+            {
+                if (r->candidates[HOUSES[h][i]] & (1 << d))
+                    where |= 1 << i;
+            }
+            if (where)
+            {
+                digits[num_digits] = d;
+                positions[num_digits++] = where;
+            }
+        }
+        for (int i = 0; i < 9; i++)
+        {
+            num_empty += r->values[HOUSES[h][i]] == 0;
+        }
+        if (num_digits <= size || num_empty <= size)
+            continue;
+
+        for (int set = (1 << size) - 1; set < (1 << num_digits); set = rate_next_combination(set))
+        {
+            int where = 0;
+            int keep = 0;
+            for (int i = 0; i < num_digits; i++)
+            {
+                if (set & (1 << i))
+                {
+                    where |= positions[i];
+                    keep |= 1 << digits[i];
+                }
+            }
+            if (count_ones(where) != size)
+                continue;
+
+            for (int i = 0; i < 9; i++)
+            {
+                if (where & (1 << i))
+                    rate_eliminate(r, c, HOUSES[h][i], RATE_ALL_DIGITS & ~keep);
+            }
+        }
+    }
+}
+
+/**
+ * Size rows where a digit fits in the same size columns, the digit must be
+ * in these rows for every one of the columns, so the other rows of the columns
+ * lose it (X-Wing for 2, Swordfish for 3). The same goes with rows and columns
+ * swapped
+ */
+static void rate_fish(Rating *r, RateChanges *c, int size)
+{
+    for (int d = 1; d <= 9; d++)
+    {
+        int bit = 1 << d;
+        //the rows are the base first and then the columns
+        for (int base = 0; base < 2; base++)
+        {
+            const uint8_t(*lines)[9] = (base == 0) ? ROWS : COLUMNS;
+            const uint8_t(*covers)[9] = (base == 0) ? COLUMNS : ROWS;
+
+            int line_ids[9];
+            int positions[9];
+            int num_lines = 0;
+            for (int l = 0; l < 9; l++)
+            {
+                int where = 0;
+                for (int i = 0; i < 9; i++)
+                {
+                    if (r->candidates[lines[l][i]] & bit)
+                        where |= 1 << i;
+                }
+                int n = count_ones(where);
+                if (n >= 2 && n <= size)
+                {
+                    line_ids[num_lines] = l;
+                    positions[num_lines++] = where;
+                }
+            }
+            if (num_lines < size)
+                continue;
+
+            for (int set = (1 << size) - 1; set < (1 << num_lines); set = rate_next_combination(set))
+            {
+                int where = 0;
+                int chosen = 0;
+                for (int i = 0; i < num_lines; i++)
+                {
+                    if (set & (1 << i))
+                    {
+                        where |= positions[i];
+                        chosen |= 1 << line_ids[i];
+                    }
+                }
+                if (count_ones(where) != size)
+                    continue;
+
+                //cell i of cover line k is in base line i
+                for (int k = 0; k < 9; k++)
+                {
+                    if (!(where & (1 << k)))
+                        continue;
+                    for (int i = 0; i < 9; i++)
+                    {
+                        if (!(chosen & (1 << i)))
+                            rate_eliminate(r, c, covers[k][i], bit);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * This function looks for every instance of a technique
+ */
+static void rate_find(Rating *r, int technique, RateChanges *c)
+{
+    switch (technique)
+    {
+    case RATE_HIDDEN_SINGLE:
+        rate_hidden_singles(r, c);
+        break;
+    case RATE_NAKED_SINGLE:
+        rate_naked_singles(r, c);
+        break;
+    case RATE_LOCKED_CANDIDATES:
+        rate_locked_candidates(r, c);
+        break;
+    case RATE_NAKED_PAIR:
+        rate_naked_subsets(r, c, 2);
+        break;
+    case RATE_X_WING:
+        rate_fish(r, c, 2);
+        break;
+    case RATE_HIDDEN_PAIR:
+        rate_hidden_subsets(r, c, 2);
+        break;
+    case RATE_NAKED_TRIPLE:
+        rate_naked_subsets(r, c, 3);
+        break;
+    case RATE_SWORDFISH:
+        rate_fish(r, c, 3);
+        break;
+    case RATE_HIDDEN_TRIPLE:
+        rate_hidden_subsets(r, c, 3);
+        break;
+    case RATE_NAKED_QUAD:
+        rate_naked_subsets(r, c, 4);
+        break;
+    case RATE_HIDDEN_QUAD:
+        rate_hidden_subsets(r, c, 4);
+        break;
+    }
+}
+
+/**
+ * This function applies the changes a technique found. Returns false if
+ * they contradict each other
+ */
+static int rate_apply(Rating *r, RateChanges *c)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        int value = c->place[i];
+        if (value == 0)
+            continue;
+        //a value that was filled in this round took the candidate away
+        if (!(r->candidates[i] & (1 << value)))
+            return 0;
+        rate_place(r, i, value);
+    }
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        r->candidates[i] &= ~c->remove[i];
+    }
+    return 1;
+}
+
+/**
+ * This function records that a technique was needed
+ */
+static void rate_use(Rating *r, int technique)
+{
+    r->uses[technique]++;
+    if (technique > r->hardest)
+    {
+        r->hardest = technique;
+        r->score = RATE_TECHNIQUE_SCORES[technique];
+    }
+}
+
+/**
+ * This function solves as much of the sudoku as the techniques can. Returns
+ * SUDOKU_SOLVED if they solved it, SUDOKU_NO_SOLUTUION if they found that it
+ * has no solution and SUDOKU_UNDECIDED if they were not enough
+ */
+int rate_logic(Rating *r)
+{
+    if (r->invalid)
+        return SUDOKU_NO_SOLUTUION;
+
+    while (r->num_empty > 0)
+    {
+        if (!rate_is_consistent(r))
+            return SUDOKU_NO_SOLUTUION;
+
+        //the cheapest technique that finds anything
+        RateChanges c;
+        int technique;
+        for (technique = 0; technique < RATE_SEARCH; technique++)
+        {
+            memset(&c, 0, sizeof(RateChanges));
+            rate_find(r, technique, &c);
+            if (c.any)
+                break;
+        }
+        if (technique == RATE_SEARCH)
+            return SUDOKU_UNDECIDED;
+
+        if (c.conflict || !rate_apply(r, &c))
+            return SUDOKU_NO_SOLUTUION;
+        rate_use(r, technique);
+    }
+
+    return SUDOKU_SOLVED;
+}
+
+/**
+ * This function solves the rest of a sudoku that the techniques couldn't
+ * with the bitboard engine. Returns one of the SUDOKU_* result codes
+ */
+int rate_search(Rating *r)
+{
+    Bitboard b;
+    char sudoku[SUDOKU_CELLS];
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        sudoku[i] = (char)('0' + r->values[i]);
+    }
+
+    int result, steps;
+    bitboard_load_from_char(&b, sudoku);
+    bitboard_solve(&b, &result, &steps);
+    rate_use(r, RATE_SEARCH);
+
+    if (result == SUDOKU_SOLVED)
+    {
+        memcpy(r->values, b.values, SUDOKU_CELLS);
+        memset(r->candidates, 0, sizeof(r->candidates));
+        r->num_empty = 0;
+    }
+    return result;
+}
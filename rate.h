@@ -0,0 +1,60 @@
+#if !defined(RATE_H)
+#define RATE_H
+
+#include <stdint.h>
+#include "tables.h"
+
+/**
+ * The techniques of the rating engine, from the cheapest to the hardest.
+ * RATE_SEARCH means that the techniques were not enough and the rest of
+ * the sudoku had to be searched
+ */
+typedef enum _RateTechnique
+{
+    RATE_HIDDEN_SINGLE,
+    RATE_NAKED_SINGLE,
+    RATE_LOCKED_CANDIDATES,
+    RATE_NAKED_PAIR,
+    RATE_X_WING,
+    RATE_HIDDEN_PAIR,
+    RATE_NAKED_TRIPLE,
+    RATE_SWORDFISH,
+    RATE_HIDDEN_TRIPLE,
+    RATE_NAKED_QUAD,
+    RATE_HIDDEN_QUAD,
+    RATE_SEARCH,
+    RATE_TECHNIQUES
+} RateTechnique;
+
+extern const char *RATE_TECHNIQUE_NAMES[RATE_TECHNIQUES];
+//the score of every technique, in tenths
+extern const int RATE_TECHNIQUE_SCORES[RATE_TECHNIQUES];
+
+/**
+ * A sudoku for the rating engine. Every round the cheapest technique that
+ * makes progress is applied everywhere at once, so the rating doesn't depend
+ * on the order of the cells and is the same for every orientation of a sudoku
+ */
+typedef struct _Rating
+{
+    //the values of the cells, 0 for the empty ones
+    uint8_t values[SUDOKU_CELLS];
+    //the candidates of every empty cell as bits 1 to 9, 0 for the filled ones
+    uint16_t candidates[SUDOKU_CELLS];
+    int num_empty;
+    //whether the givens contradict each other
+    int invalid;
+
+    //the score of the hardest technique that was needed, in tenths
+    int score;
+    //the hardest technique that was needed
+    int hardest;
+    //how many rounds every technique was applied in
+    int uses[RATE_TECHNIQUES];
+} Rating;
+
+void rate_load_from_char(Rating *r, char *data);
+int rate_logic(Rating *r);
+int rate_search(Rating *r);
+
+#endif // RATE_H
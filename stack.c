@@ -6,11 +6,13 @@
 
 /*
  * A generic stack structure that holds non negative numbers.
- * It has a stack pointer that points to the head stack element.
- * The size indicates how many elements are stored in the stack.
- * 
- * The element structure has a data field that holds the data and a next field
- * that holds its next stack element
+ * The elements are stored in a fixed size array, data[0] is the bottom
+ * of the stack and data[size - 1] is its head. The size indicates how
+ * many elements are stored in the stack.
+ *
+ * A stack can hold at most STACK_CAPACITY elements. Since the elements are
+ * part of the stack itself, pushing and popping never allocate memory and a
+ * stack can live inside another structure or on the call stack.
  */
 
 /*
@@ -20,64 +22,41 @@ stack *create_stack()
 {
     //allocate the memory needed by the stack
     stack *s = (stack *)malloc(sizeof(stack));
-    //set the sp to point at "nothing"
-    s->sp = NULL;
-    //the stack is empty so the size is 0
-    s->size = 0;
+    //and make it empty
+    stack_init(s);
     //return the stack
     return s;
 }
 
 /*
- * This function creates an isolated element with a specific value
+ * This function initializes a stack that lives in memory owned by the caller
  */
-elem *create_elem(int n)
+void stack_init(stack *s)
 {
-    //allocate the memory needed by the element itself
-    elem *e = (elem *)malloc(sizeof(elem));
-    //set the data of the element the same as the given data
-    e->data = n;
-    //the element is isolated so it has no next element
-    e->next = NULL;
-    //return the newly created element
-    return e;
+    //the stack is empty so the size is 0
+    s->size = 0;
 }
 
 /*
- * This function frees a stack from memory. First it deletes/frees all the
- * elements it the stack using the clear function and then frees the memory
- * it uses itself
+ * This function frees a stack from memory. The elements are part of
+ * the stack so it only needs to free itself
  */
 void free_stack(stack *s)
 {
-    stack_clear(s);
     free(s);
 }
 
 /*
- * This function frees the memory that is used by a stack element.
- * Since it doesn't allocate any extra memory, it only needs to free itself
- */
-void free_elem(elem *e)
-{
-    free(e);
-}
-
-/*
- * This function pushes a value to the stack
+ * This function pushes a value to the stack. The caller must make sure that
+ * the stack is not full, if it is the value is ignored
  */
 void stack_push(stack *s, int n)
 {
-    //first get the current stack pointer
-    elem *next = s->sp;
-    //create the new element with the given value
-    elem *new = create_elem(n);
-    //set the stack pointer to point at the new element
-    s->sp = new;
-    //point the next of the new stack pointer to the previous one
-    s->sp->next = next;
-    //increase the size of the stack by one
-    s->size += 1;
+    if (stack_is_full(s))
+        return;
+
+    //put the value after the current head and increase the size of the stack by one
+    s->data[s->size++] = n;
 }
 
 /*
@@ -102,25 +81,10 @@ stack *stack_clone(stack *s)
 {
     //create an empty stack
     stack *copy = create_stack();
-    int vals[s->size];
-
-    //get the head of the input stack
-    elem *cur = s->sp;
 
-    /**
-     * We will be going through the elements of the original stack
-     * and push the value of each element to the new stack
-     */
-    //for every element in the stack
-    while (cur)
-    {
-        //get the value of the element
-        int val = cur->data;
-        //push it to the new stack
-        stack_push(copy, val);
-        //and move to the next element
-        cur = cur->next;
-    }
+    //copy the elements in the same order
+    copy->size = s->size;
+    memcpy(copy->data, s->data, s->size * sizeof(int));
 
     //and return the stack we created
     return copy;
@@ -135,7 +99,7 @@ int stack_peek(stack *s)
     if (s && !stack_is_empty(s))
     {
         //return the value of the head
-        return s->sp->data;
+        return s->data[s->size - 1];
     }
 
     //otherwise indicate that the stack is empty to the caller
@@ -152,60 +116,31 @@ int stack_pop(stack *s)
     if (stack_is_empty(s))
         return STACK_EMPTY;
 
-    //get the value of the head
-    int r = stack_peek(s);
-    //store the current head
-    elem *prev = s->sp;
-    //move the head to point to the next element
-    s->sp = s->sp->next;
-    //free the previous head
-    free_elem(prev);
-    //decreament the size of the stack by one
-    s->size += -1;
-    //return the value of the old head
-    return r;
+    //decreament the size of the stack by one and return the value of the old head
+    return s->data[--s->size];
 }
 
 /*
- * This function removes the first element with a specific value
+ * This function removes the first element with a specific value,
+ * starting from the head of the stack
  */
 int stack_remove(stack *s, int val)
 {
-    //holds the element we were looking at previously
-    elem *prev = NULL;
-    //holds the element that we are inspecting
-    //(starting with the head of the stack)
-    elem *cur = s->sp;
-    //so long as there is an element to inspect
-    while (cur != NULL)
+    //inspect the elements starting with the head of the stack
+    for (int i = s->size - 1; i >= 0; i--)
     {
         //if the element should be removed
-        if (cur->data == val)
+        if (s->data[i] == val)
         {
-            //if we need to remove the head of the list
-            if (prev == NULL)
-            {
-                //set the stack pointer to point the next of the head
-                s->sp = cur->next;
-            }
-            //otherwise if it's another element
-            else
-            {
-                //set the next of the previous element to equal
-                //the next of the current element
-                prev->next = cur->next;
-            }
+            //move the elements above it one position down
+            memmove(&s->data[i], &s->data[i + 1], (s->size - i - 1) * sizeof(int));
 
             //we removed an element so decreament the size of the stack by one
             s->size += -1;
-            //free the element we want to remove
-            free_elem(cur);
 
             //and return 1 in order to indicate that an element was removed
             return 1;
         }
-        prev = cur;
-        cur = cur->next;
     }
 
     //if we are out of the loop that means that no element should be removed
@@ -219,19 +154,21 @@ int stack_remove(stack *s, int val)
  */
 int stack_remove_all(stack *s, int val)
 {
-    //holds how many elements have been removed
-    int count = 0;
-    //holds the result of the remove_one function
-    int rem = 1;
-    //so long as we have removed another element
-    while (rem)
+    //holds how many elements have been kept
+    int kept = 0;
+    //for every element starting from the bottom
+    for (int i = 0; i < s->size; i++)
     {
-        //try to remove another one
-        rem = stack_remove(s, val);
-        //increament the total count
-        count += rem;
+        //keep it only if it doesn't have that value
+        if (s->data[i] != val)
+        {
+            s->data[kept++] = s->data[i];
+        }
     }
+
     //return how many elements were removed
+    int count = s->size - kept;
+    s->size = kept;
     return count;
 }
 
@@ -240,15 +177,7 @@ int stack_remove_all(stack *s, int val)
  */
 void stack_clear(stack *s)
 {
-    //run this "forever"
-    while (1)
-    {
-        //remove an element from the stack
-        stack_pop(s);
-        //if the stack is empty break out of the loop
-        if (stack_is_empty(s))
-            break;
-    }
+    s->size = 0;
 }
 
 /*
@@ -268,12 +197,20 @@ int stack_is_empty(stack *s)
     return stack_get_size(s) == 0;
 }
 
+/*
+ * This function returns true when no more elements can be pushed to a stack
+ */
+int stack_is_full(stack *s)
+{
+    return stack_get_size(s) == STACK_CAPACITY;
+}
+
 /**
  * This function "converts" a stack to a string
  * It receives a stack a buffer as arguments.
  * The function writes the contents of the stack
  * to the buffer and in the end returns the filled in
- * buffer. If no buffer is provider the function 
+ * buffer. If no buffer is provider the function
  * creates one for itself.
  */
 char *stack_to_string(stack *s, char *buff)
@@ -284,7 +221,7 @@ char *stack_to_string(stack *s, char *buff)
 
     //how many chars we will need
     //for now this is an overestimation
-    int str_len = 20 + 4 * stack_get_size(s);
+    int str_len = 20 + 13 * stack_get_size(s);
 
     //if the caller didn't provide a buffer to write
     //we create one for ourselves.
@@ -297,7 +234,7 @@ char *stack_to_string(stack *s, char *buff)
     //reset the buffer
     memset(buff, 0, str_len);
 
-    char num_str[3];
+    char num_str[12];
     //some helper constant strings
     char *commaspace = ", ";
     char *prefix = "Stack %p: [";
@@ -307,21 +244,17 @@ char *stack_to_string(stack *s, char *buff)
     sprintf(buff, prefix, s);
 
     //start at the head of the stack
-    elem *cur = s->sp;
-    //so long as the cur is a valid element
-    while (cur != NULL)
+    for (int i = s->size - 1; i >= 0; i--)
     {
         //convert the value of the element to a string
-        sprintf(num_str, "%d", cur->data);
+        sprintf(num_str, "%d", s->data[i]);
 
         //and add it to the buffer
         strcat(buff, num_str);
 
-        //go the next element
-        cur = cur->next;
         //if there is another element after the one that was printed
         //print a comma for readability
-        if (cur != NULL)
+        if (i > 0)
             strcat(buff, commaspace);
     }
 
@@ -352,17 +285,13 @@ void stack_print(stack *s)
  */
 int stack_contains(stack *s, int val)
 {
-    //start with the top of the stack
-    elem *e = s->sp;
-    //so long as there are still elements to consider
-    while (e != NULL)
+    //for every element in the stack
+    for (int i = 0; i < s->size; i++)
     {
         //if that element has the same value as the one we are looking for
         //we can immediatelly return one
-        if (e->data == val)
+        if (s->data[i] == val)
             return 1;
-        //otherwise move to the next element
-        e = e->next;
     }
     //we traversed through the entire stack and couldn't find
     //an element with that value so we can safely return false
@@ -372,7 +301,7 @@ int stack_contains(stack *s, int val)
 /**
  * This function returns a stack containing only the
  * values that are in both the input stacks and in the
- * same position
+ * same position, counting from the head of each stack
  * stack_intersection([3,1,5], [3,1,5]) -> [3,1,5]
  * stack_intersection([1,3,4], [3,1,5]) -> []
  * stack_intersection([3,4,2], [3,1,5]) -> [3]
@@ -392,33 +321,29 @@ stack *stack_intersection_one_to_one(stack *s1, stack *s2, stack *to_write_in)
         stack_clear(to_write_in);
     }
 
-    //declare two elem variables, that will each traverse each stack
-    elem *e1, *e2;
-    //they both start at the head of each stack
-    e1 = s1->sp;
-    e2 = s2->sp;
+    //the two positions start at the head of each stack
+    int i1 = s1->size - 1;
+    int i2 = s2->size - 1;
     //so long as there are elements to consider
-    while (e1 != NULL && e2 != NULL)
+    while (i1 >= 0 && i2 >= 0)
     {
         //if we found a pair of elements that are equal
-        if (e1->data == e2->data)
+        if (s1->data[i1] == s2->data[i2])
         {
             //push it to the return stack
-            stack_push(to_write_in, e1->data);
+            stack_push(to_write_in, s1->data[i1]);
         }
         //consider the next elemtent of each stack
-        e1 = e1->next;
-        e2 = e2->next;
+        i1--;
+        i2--;
     }
-    //we went through both stacks completely and could not find an unequal pair
-    //therefore the stacks must be equal
     return to_write_in;
 }
 
 /**
- * This functions returns a stack containing the 
+ * This functions returns a stack containing the
  * elements that appear only in s1
- * 
+ *
  * stack_difference([1,2,3], [1,2]) -> [3]
  * stack_difference([1,2], [1,2,3]) -> []
  * stack_difference([3,4],[1,2,3,4,5,6]) -> []
@@ -426,22 +351,24 @@ stack *stack_intersection_one_to_one(stack *s1, stack *s2, stack *to_write_in)
  */
 stack *stack_difference(stack *s1, stack *s2, stack *to_write_in)
 {
-    if (to_write_in != NULL)
+    //if the caller didn't provide a
+    //stack to write in then create one
+    //WARNING: THIS NEEDS DO BE FREED LATER
+    if (to_write_in == NULL)
     {
-        free_stack(to_write_in);
+        to_write_in = create_stack();
     }
-    //WARNING WE CREATE A NEW STACK
-    //IT NEEDS TO BE FREED AT SOME POINT BY THE CALLER
-    to_write_in = stack_clone(s1);
 
-    elem *e2 = s2->sp;
-    while (e2)
+    //start with the elements of the first stack
+    to_write_in->size = s1->size;
+    memmove(to_write_in->data, s1->data, s1->size * sizeof(int));
+
+    for (int i = 0; i < s2->size; i++)
     {
         //for every element in the second stack
         //try and remove it from the first stack
         //if it isn't in the first stack nothing happens
-        stack_remove(to_write_in, e2->data);
-        e2->next;
+        stack_remove(to_write_in, s2->data[i]);
     }
 
     return to_write_in;
@@ -460,22 +387,6 @@ int stack_equals(stack *s1, stack *s2)
     if (stack_get_size(s1) != stack_get_size(s2))
         return 0;
 
-    //declare two elem variables, that will each traverse each stack
-    elem *e1, *e2;
-    //they both start at the head of each stack
-    e1 = s1->sp;
-    e2 = s2->sp;
-    //so long as there are elements to consider
-    while (e1 != NULL)
-    {
-        //if there are two elements that are not equal we can safely return false
-        if (e1->data != e2->data)
-            return 0;
-        //otherwise we need to consider the next elemtent of each stack
-        e1 = e1->next;
-        e2 = e2->next;
-    }
-    //we went through both stacks completely and could not find an unequal pair
-    //therefore the stacks must be equal
-    return 1;
+    //compare the elements of the two stacks one by one
+    return memcmp(s1->data, s2->data, s1->size * sizeof(int)) == 0;
 }
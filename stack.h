@@ -1,25 +1,20 @@
-
 #if !defined(STACK_H)
 #define STACK_H
 
 #include <stdlib.h>
 
-typedef struct _elem
-{
-    int data;
-    struct _elem *next;
-} elem;
+//the search never goes deeper than the number of cells of the sudoku
+#define STACK_CAPACITY 81
 
 typedef struct _stack
 {
-    elem *sp;
     int size;
+    int data[STACK_CAPACITY];
 } stack;
 
 stack *create_stack();
-elem *create_elem(int n);
+void stack_init(stack *s);
 void free_stack(stack *s);
-void free_elem(elem *e);
 void stack_push(stack *s, int n);
 void stack_push_many(stack *s, int *data, int len);
 stack *stack_clone(stack *s);
@@ -30,6 +25,7 @@ int stack_remove_all(stack *s, int val);
 void stack_clear(stack *s);
 int stack_get_size(stack *s);
 int stack_is_empty(stack *s);
+int stack_is_full(stack *s);
 char *stack_to_string(stack *s, char *buff);
 void stack_print(stack *s);
 int stack_contains(stack *s, int val);
@@ -0,0 +1,207 @@
+#include "stream.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * A pipeline for sudokus that come from a stream (e.g. a pipe) whose length
+ * we don't know. A reader thread reads the sudokus line by line into a ring
+ * buffer with a fixed number of slots, solver threads solve them and the
+ * calling thread writes the results in the order they were read. When the
+ * ring buffer is full the reader waits for the writer, so the memory that is
+ * used doesn't depend on how long the stream is.
+ */
+
+typedef struct _StreamWorker
+{
+    SudokuStream *stream;
+    int id;
+} StreamWorker;
+
+/**
+ * The loop of the reader thread
+ */
+static void *stream_reader_run(void *data)
+{
+    SudokuStream *st = (SudokuStream *)data;
+
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t len;
+    long count = 0;
+
+    //so long as there are lines to read and we need more sudokus
+    while (count < st->max_sudokus && (len = getline(&line, &line_capacity, st->in)) >= 0)
+    {
+        //only lines that are long enough hold a sudoku
+        if (len < SUDOKU_STRING_LENGTH)
+            continue;
+
+        //wait until the writer has made room in the ring buffer
+        pthread_mutex_lock(&st->lock);
+        while (st->read_seq - st->write_seq == st->capacity)
+        {
+            pthread_cond_wait(&st->not_full, &st->lock);
+        }
+        pthread_mutex_unlock(&st->lock);
+
+        //nobody else uses this slot until we publish it
+        StreamSlot *slot = &st->slots[st->read_seq % st->capacity];
+        memcpy(slot->sudoku, line, SUDOKU_STRING_LENGTH);
+        slot->sudoku[SUDOKU_STRING_LENGTH] = '\0';
+        //keep the expected solution if it follows the sudoku
+        char *expected = sudoku_line_find_solution(line, line + len);
+        if (expected != NULL)
+            memcpy(slot->expected, expected, SUDOKU_STRING_LENGTH);
+        slot->expected[(expected != NULL) ? SUDOKU_STRING_LENGTH : 0] = '\0';
+        slot->ready = 0;
+
+        //and let the solvers know that there is a new sudoku
+        pthread_mutex_lock(&st->lock);
+        st->read_seq++;
+        pthread_cond_signal(&st->has_work);
+        pthread_mutex_unlock(&st->lock);
+
+        count++;
+    }
+    free(line);
+
+    //there will be no more sudokus
+    pthread_mutex_lock(&st->lock);
+    st->eof = 1;
+    pthread_cond_broadcast(&st->has_work);
+    pthread_cond_broadcast(&st->result_ready);
+    pthread_mutex_unlock(&st->lock);
+
+    return NULL;
+}
+
+/**
+ * The loop of every solver thread
+ */
+static void *stream_solver_run(void *data)
+{
+    StreamWorker *w = (StreamWorker *)data;
+    SudokuStream *st = w->stream;
+
+    while (1)
+    {
+        //wait until there is a sudoku that nobody has taken
+        pthread_mutex_lock(&st->lock);
+        while (st->take_seq == st->read_seq && !st->eof)
+        {
+            pthread_cond_wait(&st->has_work, &st->lock);
+        }
+        //if there is none and there will be none we are done
+        if (st->take_seq == st->read_seq)
+        {
+            pthread_mutex_unlock(&st->lock);
+            break;
+        }
+        long seq = st->take_seq++;
+        pthread_mutex_unlock(&st->lock);
+
+        //solve it
+        StreamSlot *slot = &st->slots[seq % st->capacity];
+        st->solve(st->arg, w->id, slot->sudoku, (slot->expected[0] != '\0') ? slot->expected : NULL, slot->result);
+
+        //and let the writer know that it is ready
+        pthread_mutex_lock(&st->lock);
+        slot->ready = 1;
+        pthread_cond_broadcast(&st->result_ready);
+        pthread_mutex_unlock(&st->lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * This function reads at most max_sudokus sudokus from a stream, solves them
+ * with num_threads threads and writes the results as soon as all the sudokus
+ * before them have been written. At most capacity sudokus are held in memory
+ * at any time, every one with a result of result_size bytes. Returns how many
+ * sudokus were written
+ */
+long stream_run(FILE *in, int max_sudokus, int num_threads, int capacity, size_t result_size,
+                StreamSolve solve, StreamWrite write, void *arg)
+{
+    SudokuStream st;
+    st.in = in;
+    st.max_sudokus = max_sudokus;
+    st.capacity = capacity;
+    st.read_seq = 0;
+    st.take_seq = 0;
+    st.write_seq = 0;
+    st.eof = 0;
+    st.solve = solve;
+    st.write = write;
+    st.arg = arg;
+    pthread_mutex_init(&st.lock, NULL);
+    pthread_cond_init(&st.not_full, NULL);
+    pthread_cond_init(&st.has_work, NULL);
+    pthread_cond_init(&st.result_ready, NULL);
+
+    //all the memory of the pipeline is allocated here once
+    st.slots = (StreamSlot *)calloc(capacity, sizeof(StreamSlot));
+    char *results = (char *)calloc(capacity, result_size);
+    for (int i = 0; i < capacity; i++)
+    {
+        st.slots[i].result = results + i * result_size;
+    }
+
+    //start the reader and the solvers
+    pthread_t reader;
+    pthread_create(&reader, NULL, stream_reader_run, &st);
+    pthread_t *solvers = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    StreamWorker *workers = (StreamWorker *)malloc(num_threads * sizeof(StreamWorker));
+    for (int i = 0; i < num_threads; i++)
+    {
+        workers[i].stream = &st;
+        workers[i].id = i;
+        pthread_create(&solvers[i], NULL, stream_solver_run, &workers[i]);
+    }
+
+    //and write the results in order
+    while (1)
+    {
+        pthread_mutex_lock(&st.lock);
+        //wait until the next result is ready or there will be no more results
+        while (!(st.write_seq < st.read_seq && st.slots[st.write_seq % capacity].ready) &&
+               !(st.eof && st.write_seq == st.read_seq))
+        {
+            pthread_cond_wait(&st.result_ready, &st.lock);
+        }
+        if (st.write_seq == st.read_seq)
+        {
+            pthread_mutex_unlock(&st.lock);
+            break;
+        }
+        pthread_mutex_unlock(&st.lock);
+
+        StreamSlot *slot = &st.slots[st.write_seq % capacity];
+        write(arg, slot->sudoku, slot->result);
+
+        //the slot can be filled in again
+        pthread_mutex_lock(&st.lock);
+        slot->ready = 0;
+        st.write_seq++;
+        pthread_cond_signal(&st.not_full);
+        pthread_mutex_unlock(&st.lock);
+    }
+
+    pthread_join(reader, NULL);
+    for (int i = 0; i < num_threads; i++)
+    {
+        pthread_join(solvers[i], NULL);
+    }
+
+    free(solvers);
+    free(workers);
+    free(results);
+    free(st.slots);
+    pthread_mutex_destroy(&st.lock);
+    pthread_cond_destroy(&st.not_full);
+    pthread_cond_destroy(&st.has_work);
+    pthread_cond_destroy(&st.result_ready);
+
+    return st.write_seq;
+}
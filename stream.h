@@ -0,0 +1,66 @@
+#if !defined(STREAM_H)
+#define STREAM_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "file.h"
+
+/**
+ * Solves the sudoku string of a slot and writes the result in the slot.
+ * It is called by the solver threads, the worker is the id of the thread.
+ * The expected solution is the one that followed the sudoku on its line,
+ * NULL if there was none
+ */
+typedef void (*StreamSolve)(void *arg, int worker, char *sudoku, char *expected, void *result);
+
+/**
+ * Writes the result of a slot. It is called by the thread that called
+ * stream_run, once for every sudoku and in the order they were read
+ */
+typedef void (*StreamWrite)(void *arg, char *sudoku, void *result);
+
+/**
+ * A slot of the ring buffer that the reader, the solvers and the writer share
+ */
+typedef struct _StreamSlot
+{
+    char sudoku[SUDOKU_STRING_LENGTH + 1];
+    //the expected solution, empty if the line had none
+    char expected[SUDOKU_STRING_LENGTH + 1];
+    int ready;
+    void *result;
+} StreamSlot;
+
+/**
+ * A bounded pipeline that reads sudokus from a stream, solves them and
+ * writes the results. The sequence numbers only ever increase, a sequence
+ * number is held by slot seq % capacity
+ */
+typedef struct _SudokuStream
+{
+    FILE *in;
+    int max_sudokus;
+    int capacity;
+    StreamSlot *slots;
+
+    //the next sequence number the reader fills in,
+    //the solvers take and the writer writes
+    long read_seq;
+    long take_seq;
+    long write_seq;
+    int eof;
+
+    StreamSolve solve;
+    StreamWrite write;
+    void *arg;
+
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    pthread_cond_t has_work;
+    pthread_cond_t result_ready;
+} SudokuStream;
+
+long stream_run(FILE *in, int max_sudokus, int num_threads, int capacity, size_t result_size,
+                StreamSolve solve, StreamWrite write, void *arg);
+
+#endif // STREAM_H
@@ -5,88 +5,76 @@
 #define NO_VALID_POS -1
 
 /**
-* A sudoku instance represents a sudoku puzzle at a specific state. It contains a
-* sudoku cell array (nodes) that represents all the cells that a sudoku is comprised of.
-* It has an indeces stack that is used to hold the backtracking path in which we
-* are. In has a size that represents the size of the sudoku puzzle.
+* A sudoku instance represents a sudoku puzzle at a specific state. All of its state
+* is held inline in flat arrays, so a whole puzzle lives in a single block of memory.
+* values holds the filled in value of every cell and pencilmarks holds the pencilmarks
+* of every cell. It has an indeces stack that is used to hold the backtracking path in
+* which we are. In has a size that represents the size of the sudoku puzzle.
 * nextIndex represents the index of the cell that is at the end of the backtracking
-* path. rows, columns and boxes are 2d arrays that contain the indeces of the cells
-* that belong to each row, column or box
+* path. The indeces of the cells that belong to each row, column or box and the
+* neighbors of each cell are the same for every puzzle, they are the constant
+* ROWS, COLUMNS, BOXES and NEIGHBORS tables
 */
 
 /**
- * This function creates an empty sudoku puzzle. It sets the size to 81 (as in a
- * 9x9 grid). It allocates the necessary memory for the nodes array, the indeces
- * stack and the rows, cols, boxes arrays and sets nextIndex to the appropriate value
+ * This function creates an empty sudoku puzzle. The whole puzzle is one aligned
+ * allocation, everything else is initialized by sudoku_init
  */
 Sudoku *create_sudoku()
 {
-    //memory for sudoku object itself
-    Sudoku *s = (Sudoku *)malloc(sizeof(Sudoku));
-    s->size = 81;
-    //memory for all the nodes
-    s->nodes = (Cell **)malloc(sizeof(Cell *) * s->size);
+    //memory for sudoku object itself, aligned so that the values and
+    //pencilmarks arrays start at the beginning of a cache line
+    Sudoku *s = (Sudoku *)aligned_alloc(SUDOKU_CACHE_LINE, sizeof(Sudoku));
+    sudoku_init(s);
+    return s;
+}
+
+/**
+ * This function initializes a sudoku instance that lives in memory owned by
+ * the caller (e.g. on the stack). It sets the size to 81 (as in a 9x9 grid),
+ * empties all the cells and the indeces stacks and sets nextIndex to
+ * the appropriate value. The neighbors of every cell and the rows, cols, boxes
+ * arrays are constant so there is nothing to calculate for them
+ */
+void sudoku_init(Sudoku *s)
+{
+    s->size = SUDOKU_CELLS;
+    //all the cells are empty and have no pencilmarks
+    memset(s->values, 0, sizeof(s->values));
+    memset(s->pencilmarks, 0, sizeof(s->pencilmarks));
+    memset(s->value_freq, 0, sizeof(s->value_freq));
+    memset(s->row_used, 0, sizeof(s->row_used));
+    memset(s->col_used, 0, sizeof(s->col_used));
+    memset(s->box_used, 0, sizeof(s->box_used));
+    memset(&s->empty_cells, 0, sizeof(s->empty_cells));
+    s->dirty_houses = 0;
+    s->num_empty = 0;
+    s->rejected_value = 0;
     //empty stack for the indeces and their history
-    s->indeces = create_stack();
-    s->indeces_history = create_stack();
+    stack_init(&s->indeces);
+    stack_init(&s->indeces_history);
+    //nothing has changed yet
+    s->trail_size = 0;
+    stack_init(&s->trail_marks);
     //we haven't started solving
     s->nextIndex = INDEX_UNINITIALIZED;
+    s->have_guessed = 0;
+    s->print_history = 0;
     s->with_pencilmarks = 1;
-
-    s->value_freq = (int *)malloc(sizeof(int) * 10);
-    s->empty_indeces = (int *)malloc(sizeof(int) * 81);
-
-    //allocate memory for 3 2d arrays
-    s->rows = (int **)malloc(sizeof(int *) * 9);
-    s->columns = (int **)malloc(sizeof(int *) * 9);
-    s->boxes = (int **)malloc(sizeof(int *) * 9);
-    for (int i = 0; i < 9; i++)
-    {
-        s->rows[i] = (int *)malloc(sizeof(int) * 9);
-        s->columns[i] = (int *)malloc(sizeof(int) * 9);
-        s->boxes[i] = (int *)malloc(sizeof(int) * 9);
-    }
-    return s;
+    s->cell_rule = SUDOKU_CELL_FIRST_FEWEST;
+    s->value_rule = SUDOKU_VALUE_LEAST_FREQUENT;
+    s->cancel = NULL;
+#if defined(SUDOKU_STATS)
+    memset(&s->stats, 0, sizeof(SudokuStats));
+#endif
 }
 
 /**
- * This function frees a sudoku instance from memory. First it frees the memory used
- * by each cell that defines the sudoku puzzle. Then it frees the nodes array and
- * the indeces stack. It frees the 3 2d arrays and lastly it frees the memory used by itself
+ * This function frees a sudoku instance from memory. Everything, including
+ * the stacks, is held inline so there is nothing else to free
  */
 void sudoku_free(Sudoku *s)
 {
-    //for every cell
-    for (int i = 0; i < s->size; i++)
-    {
-        //free the cell
-        free_cell(s->nodes[i]);
-    }
-    //free the array of the cells
-    free(s->nodes);
-
-    //free the indeces stack
-    free_stack(s->indeces);
-    free_stack(s->indeces_history);
-
-    free(s->value_freq);
-    free(s->empty_indeces);
-
-    //for every row in the
-    //three 2d arrays
-    for (int i = 0; i < 9; i++)
-    {
-        //free the rows of the 2d arrays
-        free(s->rows[i]);
-        free(s->columns[i]);
-        free(s->boxes[i]);
-    }
-    //free the 2d arrays themselves
-    free(s->rows);
-    free(s->columns);
-    free(s->boxes);
-
-    //free the memory used by the sudoku itself
     free(s);
 }
 
@@ -130,7 +118,7 @@ char *sudoku_to_string_simple(Sudoku *s, char *buff)
     for (int i = 0; i < s->size; i++)
     {
         //get the value in it
-        int val = s->nodes[i]->value;
+        int val = s->values[i];
         //convert it to a char
         char c = (char)(val) + '0';
         //put the char in the buffer
@@ -204,7 +192,7 @@ char *sudoku_to_string_fancy(Sudoku *s, char *buff)
         }
 
         //get the value of a cell
-        int val = s->nodes[i]->value;
+        int val = s->values[i];
         //for a value different from 0, we print that value
         if (val > 0)
         {
@@ -259,41 +247,103 @@ Sudoku *sudoku_create_from_int(int *data, int with_pencilmarks)
 {
     //crete an empty sudoku instance
     Sudoku *s = create_sudoku();
+    //fill it in with the data
+    sudoku_load_from_int(s, data, with_pencilmarks);
+
+    //return the created sudoku
+    return s;
+}
+
+/**
+ * This function fills in an initialized sudoku instance with the given data
+ * and calculates everything that is needed before we start solving
+ */
+void sudoku_load_from_int(Sudoku *s, int *data, int with_pencilmarks)
+{
+    sudoku_setup_from_int(s, data, with_pencilmarks);
+    sudoku_prepare(s);
+}
+
+/**
+ * This function fills in the values of an initialized sudoku instance and
+ * the bookkeeping that follows from them, but not the pencilmarks
+ */
+void sudoku_setup_from_int(Sudoku *s, int *data, int with_pencilmarks)
+{
     sudoku_set_with_pencilmarks(s, with_pencilmarks);
 
+    memset(s->row_used, 0, sizeof(s->row_used));
+    memset(s->col_used, 0, sizeof(s->col_used));
+    memset(s->box_used, 0, sizeof(s->box_used));
+    memset(&s->empty_cells, 0, sizeof(s->empty_cells));
+    s->num_empty = 0;
+    //the loaded state is the root of the backtracking tree, there
+    //is nothing to undo before it
+    s->trail_size = 0;
+#if defined(SUDOKU_STATS)
+    //the work of the first propagation counts too
+    memset(&s->stats, 0, sizeof(SudokuStats));
+#endif
+
     //for each value in the data
     for (int i = 0; i < s->size; i++)
     {
-        //create a cell with the specific data and index and
-        //add it to the nodes array
-        s->nodes[i] = add_cell(data[i], i);
+        //put the value in the cell at that index
+        s->values[i] = (uint8_t)data[i];
+
+        if (data[i] != 0)
+        {
+            //mark the value as used in the houses of the cell
+            int bit = 1 << data[i];
+            s->row_used[cell_calculate_y(i)] |= bit;
+            s->col_used[cell_calculate_x(i)] |= bit;
+            s->box_used[cell_calculate_box(i)] |= bit;
+        }
+        else
+        {
+            //or remember that the cell is empty
+            CELL_MASK_ADD(s->empty_cells, i);
+            s->num_empty++;
+        }
     }
-    //calculate the rows collumns and boxes 2d arrays
-    sudoku_fill_rows_columns_boxes_arrays(s);
 
     //calculate the frequency of the filled in values
     sudoku_calculate_value_frequency(s);
+}
 
+/**
+ * This function calculates the pencilmarks of a sudoku that was set up and
+ * propagates them, then it picks the cell where solving starts
+ */
+void sudoku_prepare(Sudoku *s)
+{
     // calculate the pencilmakrs of all the nodes of the new sudoku
-
     sudoku_do_pencilmarks(s);
 
     //initialize the nextIndex value
     s->nextIndex = sudoku_find_next_index(s);
+}
 
-    //return the created sudoku
-    return s;
+/**
+ * This function writes the counters of the work every technique did since the
+ * sudoku was loaded, they are all zero when the solver is built without SUDOKU_STATS
+ */
+void sudoku_get_stats(Sudoku *s, SudokuStats *stats)
+{
+#if defined(SUDOKU_STATS)
+    *stats = s->stats;
+#else
+    //without SUDOKU_STATS nothing is counted
+    (void)s;
+    memset(stats, 0, sizeof(SudokuStats));
+#endif
 }
 
 /**
- * This function creates a sudoku puzzle from a string by converting the
- * string to an integer array and then returning the result of the
- * sudoku_create_from_int function
+ * This function converts a sudoku string to an integer array
  */
-Sudoku *sudoku_create_from_char(char *data, int with_pencilmarks)
+void sudoku_string_to_int(char *data, int *data_int)
 {
-    //the int array
-    int data_int[81];
     //for every char in the string
     for (int i = 0; i < 81; i++)
     {
@@ -304,11 +354,191 @@ Sudoku *sudoku_create_from_char(char *data, int with_pencilmarks)
         //set the data of the int array to that number
         data_int[i] = n;
     }
+}
+
+/**
+ * This function creates a sudoku puzzle from a string by converting the
+ * string to an integer array and then returning the result of the
+ * sudoku_create_from_int function
+ */
+Sudoku *sudoku_create_from_char(char *data, int with_pencilmarks)
+{
+    //the int array
+    int data_int[81];
+    sudoku_string_to_int(data, data_int);
     //create the sudoku using the sudoku_create_from_int function
     Sudoku *s = sudoku_create_from_int(data_int, with_pencilmarks);
     return s;
 }
 
+/**
+ * This function fills in an initialized sudoku instance from a string
+ */
+void sudoku_load_from_char(Sudoku *s, char *data, int with_pencilmarks)
+{
+    //the int array
+    int data_int[81];
+    sudoku_string_to_int(data, data_int);
+    sudoku_load_from_int(s, data_int, with_pencilmarks);
+}
+
+/**
+ * This function returns true when a value can be filled in an empty cell
+ * without it being the same as the value of one of its neighbors. Since the
+ * used values of every house are known this takes constant time
+ */
+int sudoku_value_fits(Sudoku *s, int index, int value)
+{
+    PSet used = s->row_used[cell_calculate_y(index)] |
+                s->col_used[cell_calculate_x(index)] |
+                s->box_used[cell_calculate_box(index)];
+
+    return !pencilmarks_set_contains(&used, value);
+}
+
+/**
+ * This function marks the houses of a cell as dirty. It needs to be called
+ * whenever the pencilmarks of the cell change so that the houses are examined
+ * again for hidden singles and naked partners
+ */
+void sudoku_mark_changed(Sudoku *s, int index)
+{
+    s->dirty_houses |= (1u << ROW_HOUSE(cell_calculate_y(index))) |
+                       (1u << COLUMN_HOUSE(cell_calculate_x(index))) |
+                       (1u << BOX_HOUSE(cell_calculate_box(index)));
+}
+
+/**
+ * This function appends a change to the trail. For a change of pencilmarks
+ * it needs to be called with the pencilmarks the cell had before the change
+ */
+void sudoku_trail_record(Sudoku *s, int index, int placed, PSet pencilmarks)
+{
+    TrailEntry *e = &s->trail[s->trail_size++];
+    e->index = index;
+    e->placed = placed;
+    e->pencilmarks = pencilmarks;
+
+    SUDOKU_STAT_ADD(s, mask_updates, !placed);
+}
+
+/**
+ * This function undoes every change that was made after the trail had the
+ * given size, starting from the most recent one. Its cost depends only on
+ * the number of changes and not on the size of the sudoku
+ */
+void sudoku_rollback(Sudoku *s, int trail_mark)
+{
+    while (s->trail_size > trail_mark)
+    {
+        TrailEntry *e = &s->trail[--s->trail_size];
+        if (e->placed)
+        {
+            //empty the cell again
+            sudoku_remove_value(s, e->index);
+        }
+        else
+        {
+            //give the cell its old pencilmarks back
+            s->pencilmarks[e->index] = e->pencilmarks;
+        }
+    }
+    //every house was examined when the changes were made
+    s->dirty_houses = 0;
+}
+
+/**
+ * This function changes the pencilmarks of a cell, recording the
+ * change in the trail and marking the houses of the cell
+ */
+void sudoku_set_pencilmarks(Sudoku *s, int index, PSet pencilmarks)
+{
+    sudoku_trail_record(s, index, 0, s->pencilmarks[index]);
+    s->pencilmarks[index] = pencilmarks;
+    sudoku_mark_changed(s, index);
+}
+
+/**
+ * This function fills in a value in an empty cell. The value is marked as used
+ * in the row, column and box of the cell. When we are using pencilmarks, the
+ * value is also removed from the pencilmarks of the empty neighbors, these are
+ * the only cells whose pencilmarks can change. Everything is recorded in the
+ * trail
+ */
+void sudoku_place_value(Sudoku *s, int index, int value)
+{
+    int bit = 1 << value;
+
+    sudoku_trail_record(s, index, 1, s->pencilmarks[index]);
+
+    s->values[index] = value;
+    s->row_used[cell_calculate_y(index)] |= bit;
+    s->col_used[cell_calculate_x(index)] |= bit;
+    s->box_used[cell_calculate_box(index)] |= bit;
+
+    CELL_MASK_REMOVE(s->empty_cells, index);
+    s->num_empty--;
+
+    if (!s->with_pencilmarks)
+        return;
+
+    //for every neighbor
+    for (int i = 0; i < SUDOKU_NEIGHBORS; i++)
+    {
+        int n = NEIGHBORS[index][i];
+        //if it is empty and the value was one of its pencilmarks
+        if (s->values[n] == 0 && (s->pencilmarks[n] & bit))
+        {
+            //the value is no longer a pencilmark of the neighbor
+            sudoku_set_pencilmarks(s, n, s->pencilmarks[n] & ~bit);
+        }
+    }
+}
+
+/**
+ * This function empties a cell that has a value. The value is no longer used
+ * in the row, column and box of the cell. The pencilmarks of the other cells
+ * are not touched, this is only used to undo sudoku_place_value
+ */
+void sudoku_remove_value(Sudoku *s, int index)
+{
+    int bit = 1 << s->values[index];
+
+    s->row_used[cell_calculate_y(index)] &= ~bit;
+    s->col_used[cell_calculate_x(index)] &= ~bit;
+    s->box_used[cell_calculate_box(index)] &= ~bit;
+    s->values[index] = 0;
+
+    CELL_MASK_ADD(s->empty_cells, index);
+    s->num_empty++;
+}
+
+/**
+ * This function moves upwards in the backtracking tree. The cell that was
+ * filled in last is emptied and becomes the next cell, so that the values that
+ * have not been tried in it are tried next. Returns false if no cell was
+ * filled in by the search, that means every value has been tried
+ */
+int sudoku_backtrack(Sudoku *s)
+{
+    if (stack_is_empty(&s->indeces))
+        return 0;
+
+    SUDOKU_STAT_ADD(s, backtracks, 1);
+
+    //pop the last value from the indeces stack
+    s->nextIndex = stack_pop(&s->indeces);
+
+    //the value of that cell is the one we tried last
+    s->rejected_value = s->values[s->nextIndex];
+    //undo everything that happened since its value was filled in,
+    //this empties the cell and gives it back the pencilmarks that
+    //have not been tried yet
+    sudoku_rollback(s, stack_pop(&s->trail_marks));
+
+    return 1;
+}
+
 /**
  * This function runs one step of the solving algorithm
  */
@@ -329,51 +559,71 @@ int sudoku_solve_step(Sudoku *s)
         // stack_push(s->indeces_history, s->nextIndex);
 
         //get the cell that we need to find the next value
-        Cell *c = s->nodes[s->nextIndex];
-
-        //get its current value
-        int old_value = c->value;
-
-        //get the next value from the pencilmakrs stack of that cell
-        int val = cell_retrieve_next_value_from_pencilmarks(c, s->value_freq);
-        //clean up the result of the stack (if it's negative that means the stack
+        int c = s->nextIndex;
+
+        //the cell is always empty here, so its old value is the value that
+        //was tried last in it, either because it did not fit or because
+        //we moved upwards in the backtracking tree
+        int old_value = s->rejected_value;
+        s->rejected_value = 0;
+
+        //get the next value from the pencilmakrs set of that cell
+        PSet old_pencilmarks = s->pencilmarks[c];
+        int val = (s->value_rule == SUDOKU_VALUE_LEAST_FREQUENT)
+                      ? cell_retrieve_next_value_from_pencilmarks(&s->pencilmarks[c], s->value_freq)
+                      : cell_retrieve_value_in_order(&s->pencilmarks[c], s->value_freq,
+                                                     s->value_rule == SUDOKU_VALUE_MOST_FREQUENT);
+        if (s->pencilmarks[c] != old_pencilmarks)
+        {
+            sudoku_trail_record(s, c, 0, old_pencilmarks);
+        }
+        //clean up the result of the set (if it's negative that means the set
         //was empty)
-        c->value = val > 0 ? val : 0;
+        val = val > 0 ? val : 0;
 
         s->value_freq[old_value] -= 1;
-        s->value_freq[c->value] += 1;
+        s->value_freq[val] += 1;
 
         //if there is no value so that the sudoku is still valid
-        if (cell_is_empty(c))
+        if (val == 0)
         {
-            if (!stack_is_empty(s->indeces))
-            {
-                //pop the last value from the indeces stack
-                //we move upwards in the backtracking tree
-                s->nextIndex = stack_pop(s->indeces);
-            }
-
-            else
-            {
-                //if we want to pop from the indeces stack but it is empty
-                //that means that the sudoku has no solution
+            //if we want to move upwards but we are at the top of the
+            //backtracking tree that means that the sudoku has no solution
+            if (!sudoku_backtrack(s))
                 r = SUDOKU_NO_SOLUTUION;
-            }
         }
 
         //if we found a value such that, that the sudoku is still valid
-        else if (sudoku_is_valid(s))
+        else if (sudoku_value_fits(s, c, val))
         {
             //push the current index to the indeces array
             //we move downwards in the backtracking tree
-            stack_push(s->indeces, s->nextIndex);
+            stack_push(&s->indeces, s->nextIndex);
+            stack_push(&s->trail_marks, s->trail_size);
+
+            //the value was forced if it was the only pencilmark left
+            SUDOKU_STAT_ADD(s, naked_singles, pencilmarks_set_get_size(&old_pencilmarks) == 1);
+            SUDOKU_STAT_ADD(s, guesses, pencilmarks_set_get_size(&old_pencilmarks) > 1);
+            SUDOKU_STAT_MAX(s, max_depth, stack_get_size(&s->indeces));
 
-            //calculate the pencilmarks again
-            sudoku_do_pencilmarks(s);
+            //fill in the value
+            sudoku_place_value(s, c, val);
+
+            //only the neighbors of the cell changed and we only need
+            //to look at their houses again
+            if (s->with_pencilmarks)
+            {
+                sudoku_propagate_pencilmarks(s);
+            }
 
             //calculate the index of the next cell that we will try to fill in
             s->nextIndex = sudoku_find_next_index(s);
         }
+        else
+        {
+            //remember the value so that its frequency is updated next time
+            s->rejected_value = val;
+        }
     }
 
     //return the result of this iteration
@@ -399,6 +649,10 @@ int sudoku_solve(Sudoku *s, int *result, int *steps)
     int counter = 0;
     while (r == SUDOKU_UNDECIDED)
     {
+        //someone else doesn't need the solution anymore
+        if (s->cancel != NULL && atomic_load_explicit(s->cancel, memory_order_relaxed))
+            break;
+
         //run a step of the solution algorithm
         //and get its decision
         r = sudoku_solve_step(s);
@@ -425,24 +679,71 @@ int sudoku_solve(Sudoku *s, int *result, int *steps)
     return r;
 }
 
+/**
+ * This function counts the solutions of the sudoku, up until there are limit of
+ * them. Every time a solution is found we backtrack from it and keep searching
+ * in the same sudoku, so counting costs no more than the search itself. A limit
+ * of 2 tells whether the solution is unique. The first solution is left in
+ * the values of the sudoku, the result is SUDOKU_SOLVED if there is one
+ */
+int sudoku_count_solutions(Sudoku *s, int limit, int *result, int *count, int *steps)
+{
+    uint8_t first[SUDOKU_CELLS];
+    int solutions = 0;
+    int counter = 0;
+
+    int cancelled = 0;
+    while (solutions < limit)
+    {
+        if (s->cancel != NULL && atomic_load_explicit(s->cancel, memory_order_relaxed))
+        {
+            cancelled = 1;
+            break;
+        }
+
+        int r = sudoku_solve_step(s);
+        counter++;
+
+        if (r == SUDOKU_NO_SOLUTUION)
+            break;
+
+        if (r == SUDOKU_SOLVED)
+        {
+            if (solutions++ == 0)
+                memcpy(first, s->values, SUDOKU_CELLS);
+
+            //the search is over once the last value of the top cell was tried
+            if (solutions < limit && !sudoku_backtrack(s))
+                break;
+        }
+    }
+
+    if (solutions > 0)
+        memcpy(s->values, first, SUDOKU_CELLS);
+
+    *result = (solutions > 0) ? SUDOKU_SOLVED : SUDOKU_NO_SOLUTUION;
+    //the count of a search that was stopped is not complete
+    if (cancelled)
+        *result = SUDOKU_UNDECIDED;
+    *count = solutions;
+    *steps = counter - 1;
+
+    return *result;
+}
+
 /**
  * This function runs all the pencilmarks algorithms 
  * on the sudoku
  */
 int sudoku_do_pencilmarks(Sudoku *s)
 {
-    //get the indeces that are empty
-    sudoku_get_empty_indeces(s, s->empty_indeces);
     if (s->with_pencilmarks)
     {
-        //and calculate the pencilmakrs of the sudoku
+        //calculate the pencilmakrs of the sudoku
         sudoku_calculate_pencilmarks(s);
-        // find hidden singles
-        sudoku_find_hidden_pencilmakrs(s);
-        // find naked partners
-        sudoku_find_naked_pencilmarks_partners(s);
-        //find pointing pairs
-        // sudoku_do_pointing_pairs(s);
+        //and examine every house for hidden singles and naked partners
+        s->dirty_houses = SUDOKU_ALL_HOUSES;
+        sudoku_propagate_pencilmarks(s);
     }
     else
     {
@@ -452,23 +753,37 @@ int sudoku_do_pencilmarks(Sudoku *s)
     return 1;
 }
 
+/**
+ * This function examines the dirty houses for hidden singles and naked partners.
+ * Every time the pencilmarks of a cell change its houses become dirty again,
+ * so this runs until nothing changes anymore
+ */
+void sudoku_propagate_pencilmarks(Sudoku *s)
+{
+    while (s->dirty_houses)
+    {
+        //get the next dirty house
+        int house = trailing_zeros(s->dirty_houses);
+        s->dirty_houses &= ~(1u << house);
+
+        // find hidden singles
+        sudoku_find_hidden_pencilmakrs(s, house);
+        // find naked partners
+        sudoku_find_naked_pencilmarks_partners(s, house);
+    }
+}
+
 /**
  * This function sets the pencilmarks of all the empty cells to 
  * all the possible numbers in [1,..,9]
  */
 int sudoku_fill_pencilmakrs_with_dumb_values(Sudoku *s)
 {
-    for (int i = 0; i < s->size; i++)
+    CellMask empty = s->empty_cells;
+    int index;
+    while ((index = cell_mask_pop(&empty)) >= 0)
     {
-        Cell *c = s->nodes[i];
-        if (cell_is_empty(c))
-        {
-            pencilmarks_set_clear(c->pencilmakrs);
-            for (int val = 1; val <= 9; val++)
-            {
-                pencilmarks_set_add_pencilmark(c->pencilmakrs, val);
-            }
-        }
+        s->pencilmarks[index] = ALL_PENCILMARKS;
     }
 
     return 1;
@@ -477,14 +792,14 @@ int sudoku_fill_pencilmakrs_with_dumb_values(Sudoku *s)
 /**
  * Returns the number of pencilmarks in the unfilled cells
  */
-int sudoku_num_possible_pencilmarks(Sudoku *s, int *empty_indeces)
+int sudoku_num_possible_pencilmarks(Sudoku *s)
 {
     int sum = 0;
-    for (int i = 0; i < s->size; i++)
+    CellMask empty = s->empty_cells;
+    int index;
+    while ((index = cell_mask_pop(&empty)) >= 0)
     {
-        if (empty_indeces[i] < 0)
-            break;
-        sum += pencilmarks_set_get_size(s->nodes[empty_indeces[i]]->pencilmakrs);
+        sum += pencilmarks_set_get_size(&s->pencilmarks[index]);
     }
 
     return sum;
@@ -495,53 +810,51 @@ int sudoku_num_possible_pencilmarks(Sudoku *s, int *empty_indeces)
  */
 void sudoku_calculate_value_frequency(Sudoku *s)
 {
+    memset(s->value_freq, 0, sizeof(s->value_freq));
     for (int i = 0; i < s->size; i++)
     {
-        Cell *c = s->nodes[i];
-        s->value_freq[c->value] += 1;
+        s->value_freq[s->values[i]] += 1;
     }
 }
 
 /**
  * This function determines the index of the cell that we will run the
  * algorithm next on. The decision is made based on the size of the pencilmakrs
- * stack of each cell. The index of the cell that we want to return is the cell with
- * the smallest pencilmakrs stack.
+ * set of each cell. The index of the cell that we want to return is the cell with
+ * the smallest pencilmakrs set.
 */
 int sudoku_find_next_index(Sudoku *s)
 {
     //assume there exists no such cell
-    Cell *best = NULL;
-    //iterator cell
-    Cell *c;
-    //iterate over every cell
-    for (int i = 0; i < 81; i++)
+    int best = NO_VALID_POS;
+    int best_size = 0;
+    int last = s->cell_rule == SUDOKU_CELL_LAST_FEWEST;
+    //iterate over every empty cell
+    CellMask empty = s->empty_cells;
+    int index;
+    while ((index = cell_mask_pop(&empty)) >= 0)
     {
-        int index = s->empty_indeces[i];
-        if (index < 0)
-            break;
-        c = s->nodes[index];
+        int size = pencilmarks_set_get_size(&s->pencilmarks[index]);
 
-        //if the best yet is non existent or the stack of the cell that
+        //if the best yet is non existent or the set of the cell that
         //we currently observe is smaller than the current best
-        if (best == NULL ||
-            (pencilmarks_set_get_size(c->pencilmakrs) < pencilmarks_set_get_size(best->pencilmakrs)))
+        if (best == NO_VALID_POS || size < best_size || (last && size == best_size))
         {
-
             //make the current cell the current best
-            best = c;
+            best = index;
+            best_size = size;
         }
 
-        //if the stack of the current best is empty, since the size of the stack
+        //if the set of the current best is empty, since the size of the set
         //will never be negative we can break out of the loop now and return the
         //current best as the best
-        if (pencilmarks_set_get_size(best->pencilmakrs) == 0)
+        if (best_size == 0)
             break;
     }
 
-    //if the best is non existent then return NO_VALID_POS
-    //otherwise return the index of the best
-    return (best == NULL) ? NO_VALID_POS : best->index;
+    //if the best is non existent then NO_VALID_POS is returned
+    //otherwise the index of the best
+    return best;
 }
 
 /**
@@ -549,143 +862,138 @@ int sudoku_find_next_index(Sudoku *s)
  */
 void sudoku_calculate_pencilmarks(Sudoku *s)
 {
-    //for every cell
-    for (int i = 0; i < s->size; i++)
+    //for every empty cell
+    CellMask empty = s->empty_cells;
+    int index;
+    while ((index = cell_mask_pop(&empty)) >= 0)
     {
-        //get the index of the i'th empty cell
-        int index = s->empty_indeces[i];
-        //if the index is -1 that mean we have gone through all the empty cells
-        if (index < 0)
-            break;
-
-        //the cell at that index
-        Cell *c = s->nodes[index];
+        //the values that are used by the neighbors of the cell
+        PSet used = s->row_used[cell_calculate_y(index)] |
+                    s->col_used[cell_calculate_x(index)] |
+                    s->box_used[cell_calculate_box(index)];
         //let the cell calculate its pencilmarks
-        cell_calculate_pencilmarks(c, s->nodes);
+        cell_calculate_pencilmarks(index, s->values, s->pencilmarks, used);
     }
 }
 
 /**
- * This function finds hidden signles.
- * https://www.learn-sudoku.com/hidden-singles.html
+ * This function compares the pencilmarks of the cells of a house with the
+ * pencilmarks they had before a technique was applied, records the cells
+ * that changed in the trail and marks them
  */
-void sudoku_find_hidden_pencilmakrs(Sudoku *s)
+static void sudoku_mark_house_changes(Sudoku *s, int house, PSet *before)
 {
-    //for every cell
-    for (int i = 0; i < s->size; i++)
+    for (int i = 0; i < 9; i++)
     {
-        //the index of the i'th cell that is empty
-        int index = s->empty_indeces[i];
+        int index = HOUSES[house][i];
+        if (s->pencilmarks[index] != before[i])
+        {
+            sudoku_trail_record(s, index, 0, before[i]);
+            sudoku_mark_changed(s, index);
+        }
+    }
+}
 
-        //if the index is negative then we have gone through all
-        //the possible cells that are empty
-        if (index < 0)
-            break;
+#if defined(SUDOKU_STATS)
+/**
+ * This function counts the cells of a house whose pencilmarks
+ * changed since a technique was applied
+ */
+static int sudoku_count_house_changes(Sudoku *s, int house, PSet *before)
+{
+    int count = 0;
+    for (int i = 0; i < 9; i++)
+    {
+        count += s->pencilmarks[HOUSES[house][i]] != before[i];
+    }
+    return count;
+}
 
-        Cell *c = s->nodes[index];
-        //get its x,y,box
-        int cx = cell_calculate_x(c);
-        int cy = cell_calculate_y(c);
-        int cb = cell_calculate_box(c);
-
-        //run the hidden single with the cell in its row
-        cell_find_unique_pencilmarks(c, s->nodes, s->rows[cy]);
-        //then the column
-        cell_find_unique_pencilmarks(c, s->nodes, s->columns[cx]);
-        //then the box
-        cell_find_unique_pencilmarks(c, s->nodes, s->boxes[cb]);
+/**
+ * This function counts the pencilmarks a technique removed from a house
+ */
+static int sudoku_count_house_eliminations(Sudoku *s, int house, PSet *before)
+{
+    int count = 0;
+    for (int i = 0; i < 9; i++)
+    {
+        count += count_ones(before[i] & ~s->pencilmarks[HOUSES[house][i]]);
     }
+    return count;
 }
+#endif
 
 /**
- * This function runs the naked partner function on every cell
+ * This function copies the pencilmarks of the cells of a house
  */
-void sudoku_find_naked_pencilmarks_partners(Sudoku *s)
+static void sudoku_copy_house_pencilmarks(Sudoku *s, int house, PSet *buf)
 {
-    for (int i = 0; i < s->size; i++)
+    for (int i = 0; i < 9; i++)
     {
-        //the index of the i'th cell that is empty
-        int index = s->empty_indeces[i];
+        buf[i] = s->pencilmarks[HOUSES[house][i]];
+    }
+}
 
-        //if the index is negative then we have gone through all
-        //the possible cells that are empty
-        if (index < 0)
-            break;
+/**
+ * This function finds hidden signles in a house.
+ * https://www.learn-sudoku.com/hidden-singles.html
+ */
+void sudoku_find_hidden_pencilmakrs(Sudoku *s, int house)
+{
+    PSet before[9];
+    sudoku_copy_house_pencilmarks(s, house, before);
 
-        Cell *c = s->nodes[index];
-        int cx = cell_calculate_x(c);
-        int cy = cell_calculate_y(c);
-        int cb = cell_calculate_box(c);
+    //for every cell in the house
+    for (int i = 0; i < 9; i++)
+    {
+        int index = HOUSES[house][i];
+        //if it is empty
+        if (s->values[index] != 0)
+            continue;
 
-        cell_find_naked_partners(c, s->nodes, s->rows[cy]);
-        cell_find_naked_partners(c, s->nodes, s->columns[cx]);
-        cell_find_naked_partners(c, s->nodes, s->boxes[cb]);
+        //find whether it has a unique pencilmark in the house
+        cell_find_unique_pencilmarks(index, s->values, s->pencilmarks, HOUSES[house]);
     }
+
+    SUDOKU_STAT_ADD(s, hidden_singles, sudoku_count_house_changes(s, house, before));
+    sudoku_mark_house_changes(s, house, before);
 }
 
-/*
-This function calculates the indeces of all the houses of a
-sudoku puzzle. In theory this could be hard-coded but obviously this solution
-is more elegant
-*/
-void sudoku_fill_rows_columns_boxes_arrays(Sudoku *s)
+/**
+ * This function runs the naked partner function on every cell of a house
+ */
+void sudoku_find_naked_pencilmarks_partners(Sudoku *s, int house)
 {
-    //we need in total 27 counters for 27 houses
-    //9 rows, 9 columns and 9 boxes
+    PSet before[9];
+    sudoku_copy_house_pencilmarks(s, house, before);
 
-    int row_size = 9;
-
-    int counters_rows[row_size];
-    int counters_columns[row_size];
-    int counters_boxes[row_size];
-    //initialize all the counters with 0
-    memset(counters_rows, 0, row_size * sizeof(int));
-    memset(counters_columns, 0, row_size * sizeof(int));
-    memset(counters_boxes, 0, row_size * sizeof(int));
-
-    //for every cell
-    for (int i = 0; i < s->size; i++)
+    for (int i = 0; i < 9; i++)
     {
-        Cell *c = s->nodes[i];
-        //x gives us which column
-        int cx = cell_calculate_x(c);
-        //y which row
-        int cy = cell_calculate_y(c);
-        //b which box
-        int cb = cell_calculate_box(c);
-
-        //put that index in the appropriate column array and increament the counter
-        s->columns[cx][counters_columns[cx]++] = i;
-        //same for row
-        s->rows[cy][counters_rows[cy]++] = i;
-        //and box
-        s->boxes[cb][counters_boxes[cb]++] = i;
+        int index = HOUSES[house][i];
+
+        cell_find_naked_partners(index, s->values, s->pencilmarks, HOUSES[house]);
     }
+
+    SUDOKU_STAT_ADD(s, naked_partner_eliminations, sudoku_count_house_eliminations(s, house, before));
+    sudoku_mark_house_changes(s, house, before);
 }
 
 // TODO this is unused because it is broken for now
 // TODO Fix pointing_pair function is cell
 void sudoku_do_pointing_pairs(Sudoku *s)
 {
-    //for every cell
-    for (int i = 0; i < s->size; i++)
+    //for every empty cell
+    CellMask empty = s->empty_cells;
+    int index;
+    while ((index = cell_mask_pop(&empty)) >= 0)
     {
-        //the index of the i'th cell that is empty
-        int index = s->empty_indeces[i];
-
-        //if the index is negative then we have gone through all
-        //the possible cells that are empty
-        if (index < 0)
-            break;
-
-        Cell *c = s->nodes[index];
         //get its x,y,box
-        int cx = cell_calculate_x(c);
-        int cy = cell_calculate_y(c);
-        int cb = cell_calculate_box(c);
+        int cx = cell_calculate_x(index);
+        int cy = cell_calculate_y(index);
+        int cb = cell_calculate_box(index);
 
         //run the pointing pair with the cell in its row
-        cell_pointing_pair(c, s->nodes, s->rows[cy], s->columns[cx], s->boxes[cb]);
+        cell_pointing_pair(index, s->values, s->pencilmarks, ROWS[cy], COLUMNS[cx], BOXES[cb]);
     }
 }
 
@@ -694,21 +1002,14 @@ void sudoku_do_pointing_pairs(Sudoku *s)
  * with the indeces of the cells of the sudoku that are still empty.
  * The function also returns how many cells are empty, i.e. the size of the buffer
  */
-int sudoku_get_empty_indeces(Sudoku *s, int *buf)
+int sudoku_get_empty_indeces(Sudoku *s, uint8_t *buf)
 {
-    //if a buffer was given fill it with -1
-    if (buf)
-    {
-        memset(buf, -1, 81 * sizeof(int));
-    }
-
     int counter = 0;
     //for every cell
     for (int i = 0; i < s->size; i++)
     {
-        Cell *c = s->nodes[i];
         //if the cell is empty
-        if (cell_is_empty(c))
+        if (cell_is_empty(s->values, i))
         {
             //add the index to the buffer (if it was given)
             if (buf)
@@ -725,42 +1026,26 @@ int sudoku_get_empty_indeces(Sudoku *s, int *buf)
 
 /**
  * This function returns false if two non-empty adjecent nodes have the same value
- * Otherwise true
+ * Otherwise true. Every house keeps a mask of the values it has seen, a value
+ * that is already in the mask appears twice
 */
 int sudoku_is_valid(Sudoku *s)
 {
-    //if we are using pencilmarks then there
-    //is no chance we will try a sudoku that is not valid
-    //there will be a cell with no pencilmarks
-    if (s->with_pencilmarks)
+    int duplicate = 0;
+    //for every row, column and box
+    for (int h = 0; h < 27; h++)
     {
-        return 1;
-    }
-
-    //for every cell
-    for (int i = 0; i < s->size; i++)
-    {
-        Cell *c = s->nodes[i];
-        //if the cell is empty ignore it
-        if (cell_is_empty(c))
-            continue;
-
-        //for every neighbor index of the cell
-        for (int j = 0; j < 20; j++)
+        int seen = 0;
+        for (int i = 0; i < 9; i++)
         {
-            //get the neighbor
-            Cell *other = s->nodes[c->neighbors[j]];
-
-            //if the nodes have the same value
-            if (c->value == other->value)
-                //return false
-                return 0;
+            //an empty cell has the bit 0 which is ignored
+            int bit = (1 << s->values[HOUSES[h][i]]) & ALL_PENCILMARKS;
+            duplicate |= seen & bit;
+            seen |= bit;
         }
     }
 
-    //we have iterated over all the cells and couldn't find any cell that
-    //has the same value as one of its neighbors. So we can return true
-    return 1;
+    return !duplicate;
 }
 
 /**
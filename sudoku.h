@@ -1,8 +1,9 @@
-
 #if !defined(SUDOKU_H)
 #define SUDOKU_H
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include "utils.h"
 #include "cell.h"
 
@@ -10,30 +11,118 @@
 #define SUDOKU_NO_SOLUTUION -1
 #define SUDOKU_UNDECIDED 0
 
+//how the search picks the next cell, the first or the last
+//of the cells with the fewest pencilmarks
+#define SUDOKU_CELL_FIRST_FEWEST 0
+#define SUDOKU_CELL_LAST_FEWEST 1
+
+//the order the values of a cell are tried in
+#define SUDOKU_VALUE_LEAST_FREQUENT 0
+#define SUDOKU_VALUE_MOST_FREQUENT 1
+#define SUDOKU_VALUE_LOWEST 2
+
+#define SUDOKU_CACHE_LINE 64
+#define SUDOKU_ALL_HOUSES 0x7ffffff
+
+//every entry of the trail removes at least one pencilmark of a cell or fills
+//in a cell, so the trail can never hold more entries than this
+#define SUDOKU_TRAIL_CAPACITY (SUDOKU_CELLS * 10)
+
+/**
+ * How much work every technique did while solving a sudoku. The counters are
+ * only kept when the solver is built with SUDOKU_STATS defined (make STATS=1),
+ * otherwise the code that updates them is compiled out
+ */
+typedef struct _SudokuStats
+{
+    //values filled in a cell that had a single pencilmark left
+    int naked_singles;
+    //cells whose pencilmarks were reduced to a value unique in a house
+    int hidden_singles;
+    //pencilmarks removed because of naked partners
+    int naked_partner_eliminations;
+    //values filled in a cell that had more than one pencilmark left
+    int guesses;
+    //how many times we moved upwards in the backtracking tree
+    int backtracks;
+    //the most values that were filled in by the search at the same time
+    int max_depth;
+    //changes of the pencilmarks of a cell
+    int mask_updates;
+} SudokuStats;
+
+#if defined(SUDOKU_STATS)
+#define SUDOKU_STAT_ADD(s, counter, n) ((s)->stats.counter += (n))
+#define SUDOKU_STAT_MAX(s, counter, n) ((s)->stats.counter = max((s)->stats.counter, (n)))
+#else
+#define SUDOKU_STAT_ADD(s, counter, n) ((void)0)
+#define SUDOKU_STAT_MAX(s, counter, n) ((void)0)
+#endif
+
+/**
+ * An entry of the trail records a single change of the sudoku, so that it
+ * can be undone when we move upwards in the backtracking tree
+ */
+typedef struct _TrailEntry
+{
+    //the cell that changed
+    uint8_t index;
+    //true if a value was filled in the cell, otherwise its pencilmarks changed
+    uint8_t placed;
+    //the pencilmarks of the cell before the change
+    PSet pencilmarks;
+} TrailEntry;
+
 typedef struct _Sudoku
 {
-    Cell **nodes;
+    //the filled in value of every cell, 0 means empty
+    uint8_t values[SUDOKU_CELLS];
+    //the pencilmarks of every cell
+    PSet pencilmarks[SUDOKU_CELLS];
+
+    //the values that are already filled in every row, column and box
+    PSet row_used[9];
+    PSet col_used[9];
+    PSet box_used[9];
+
+    //the cells that are still empty
+    CellMask empty_cells;
+    //the houses (see HOUSES) that have cells whose pencilmarks
+    //changed since the house was last examined
+    uint32_t dirty_houses;
+
+    int num_empty;
+    //a value that was tried in nextIndex but did not fit
+    int rejected_value;
+    int value_freq[10];
+
     int size;
-    stack *indeces;
-    stack *indeces_history;
     int nextIndex;
-
     int have_guessed;
-
     int print_history;
+    int with_pencilmarks;
+    //one of the SUDOKU_CELL_* and one of the SUDOKU_VALUE_* rules
+    int cell_rule;
+    int value_rule;
+    //the search gives up once this is set, it can be NULL
+    atomic_int *cancel;
 
-    int *empty_indeces;
-
-    int *value_freq;
+    stack indeces;
+    stack indeces_history;
 
-    int **rows;
-    int **columns;
-    int **boxes;
+    //the changes since the sudoku was loaded, and for every index in the
+    //indeces stack the size of the trail before its value was filled in
+    int trail_size;
+    stack trail_marks;
+    TrailEntry trail[SUDOKU_TRAIL_CAPACITY];
 
-    int with_pencilmarks;
-} Sudoku;
+#if defined(SUDOKU_STATS)
+    SudokuStats stats;
+#endif
+} __attribute__((aligned(SUDOKU_CACHE_LINE))) Sudoku;
 
 Sudoku *create_sudoku();
+void sudoku_init(Sudoku *s);
 void sudoku_free(Sudoku *s);
 int sudoku_set_with_pencilmarks(Sudoku *s, int dp);
 int sudoku_set_print_history(Sudoku *s, int ph);
@@ -42,20 +131,35 @@ char *sudoku_to_string_fancy(Sudoku *s, char *buff);
 void sudoku_print(Sudoku *s);
 Sudoku *sudoku_create_from_int(int *data, int with_pencilmarks);
 Sudoku *sudoku_create_from_char(char *data, int with_pencilmarks);
+void sudoku_load_from_int(Sudoku *s, int *data, int with_pencilmarks);
+void sudoku_load_from_char(Sudoku *s, char *data, int with_pencilmarks);
+void sudoku_setup_from_int(Sudoku *s, int *data, int with_pencilmarks);
+void sudoku_prepare(Sudoku *s);
+void sudoku_string_to_int(char *data, int *data_int);
+void sudoku_get_stats(Sudoku *s, SudokuStats *stats);
+int sudoku_value_fits(Sudoku *s, int index, int value);
+void sudoku_place_value(Sudoku *s, int index, int value);
+void sudoku_remove_value(Sudoku *s, int index);
+void sudoku_mark_changed(Sudoku *s, int index);
+void sudoku_set_pencilmarks(Sudoku *s, int index, PSet pencilmarks);
+void sudoku_trail_record(Sudoku *s, int index, int placed, PSet pencilmarks);
+void sudoku_rollback(Sudoku *s, int trail_mark);
+int sudoku_backtrack(Sudoku *s);
 int sudoku_solve_step(Sudoku *s);
 int sudoku_solve(Sudoku *s, int *result, int *steps);
+int sudoku_count_solutions(Sudoku *s, int limit, int *result, int *count, int *steps);
 int sudoku_do_pencilmarks(Sudoku *s);
 int sudoku_fill_pencilmakrs_with_dumb_values(Sudoku *s);
-int sudoku_num_possible_pencilmarks(Sudoku *s, int *empty_indeces);
+int sudoku_num_possible_pencilmarks(Sudoku *s);
 void sudoku_calculate_value_frequency(Sudoku *s);
 int sudoku_find_next_index(Sudoku *s);
 void sudoku_calculate_pencilmarks(Sudoku *s);
-void sudoku_find_hidden_pencilmakrs(Sudoku *s);
-void sudoku_find_naked_pencilmarks_partners(Sudoku *s);
-void sudoku_fill_rows_columns_boxes_arrays(Sudoku *s);
+void sudoku_propagate_pencilmarks(Sudoku *s);
+void sudoku_find_hidden_pencilmakrs(Sudoku *s, int house);
+void sudoku_find_naked_pencilmarks_partners(Sudoku *s, int house);
 void sudoku_do_pointing_pairs(Sudoku *s);
 void sudoku_do_box_pointing_pairs(Sudoku *s);
-int sudoku_get_empty_indeces(Sudoku *s, int *buf);
+int sudoku_get_empty_indeces(Sudoku *s, uint8_t *buf);
 int sudoku_is_valid(Sudoku *s);
 int sudoku_is_solved(Sudoku *s);
 int sudoku_calc_error(Sudoku *s);
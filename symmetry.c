@@ -0,0 +1,305 @@
+#include "symmetry.h"
+
+/**
+ * The canonical form of a sudoku under its symmetries: relabeling the digits,
+ * reordering the rows inside a band and the bands, the columns inside a stack
+ * and the stacks, and transposing. Two sudokus have the same canonical form
+ * exactly when one is a transformation of the other.
+ *
+ * The canonical form is the smallest string among the transformations, with
+ * the digits relabeled in the order they first appear. Trying every one of
+ * the 3 359 232 orderings of the lines would take far too long, so the lines
+ * are colored first. The color of a line only depends on the givens it shares
+ * with the other lines, so a transformation moves the colors with the lines,
+ * and only the orderings that sort the lines by color are tried. That leaves
+ * a handful of orderings for most sudokus, the ties that remain are usually
+ * lines that a symmetry of the sudoku swaps.
+ */
+
+//every ordering of three lines
+static const uint8_t PERMUTATIONS[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+
+//how many times the colors are refined
+#define SYMMETRY_ROUNDS 4
+//the orderings of the lines that sort them by color are at most 6 * 6^3
+#define SYMMETRY_MAX_ORDERS 1296
+
+/**
+ * This function mixes two colors into a new one
+ */
+static inline uint32_t symmetry_mix(uint32_t a, uint32_t b)
+{
+    uint64_t x = (((uint64_t)a << 32) | b) + 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return (uint32_t)(x ^ (x >> 31));
+}
+
+/**
+ * This function colors the rows and columns of a grid. A line starts with no
+ * color and every round its color takes in the colors of the lines that
+ * cross it at a given with the color of the given's digit, and the colors of
+ * the lines of its band or stack. A digit takes in the lines of its givens.
+ * The colors are summed so they don't depend on the order of anything, and
+ * the rows and columns are treated the same so transposing swaps their colors
+ */
+static void symmetry_color(const uint8_t *grid, uint32_t *rows, uint32_t *cols)
+{
+    uint32_t digits[10] = {0};
+    memset(rows, 0, 9 * sizeof(uint32_t));
+    memset(cols, 0, 9 * sizeof(uint32_t));
+
+    for (int round = 0; round < SYMMETRY_ROUNDS; round++)
+    {
+        uint32_t bands[3] = {0};
+        uint32_t stacks[3] = {0};
+        for (int l = 0; l < 9; l++)
+        {
+            bands[l / 3] += symmetry_mix(rows[l], 1);
+            stacks[l / 3] += symmetry_mix(cols[l], 1);
+        }
+
+        uint32_t new_rows[9];
+        uint32_t new_cols[9];
+        uint32_t new_digits[10];
+        for (int l = 0; l < 9; l++)
+        {
+            new_rows[l] = symmetry_mix(rows[l], bands[l / 3]);
+            new_cols[l] = symmetry_mix(cols[l], stacks[l / 3]);
+        }
+        for (int d = 0; d < 10; d++)
+        {
+            new_digits[d] = symmetry_mix(digits[d], 2);
+        }
+
+        for (int i = 0; i < SUDOKU_CELLS; i++)
+        {
+            int d = grid[i];
+            if (d == 0)
+                continue;
+
+            uint32_t r = rows[i / 9];
+            uint32_t c = cols[i % 9];
+            new_rows[i / 9] += symmetry_mix(c, digits[d]);
+            new_cols[i % 9] += symmetry_mix(r, digits[d]);
+            new_digits[d] += (r < c) ? symmetry_mix(r, c) : symmetry_mix(c, r);
+        }
+
+        memcpy(rows, new_rows, sizeof(new_rows));
+        memcpy(cols, new_cols, sizeof(new_cols));
+        memcpy(digits, new_digits, sizeof(new_digits));
+    }
+}
+
+/**
+ * This function writes every ordering of the lines that puts their groups
+ * (bands or stacks) and the lines inside every group in the order of their
+ * colors. Lines with the same color can go in any order, so all of their
+ * orderings are written. Returns how many there are
+ */
+static int symmetry_orders(const uint32_t *colors, uint8_t (*orders)[9])
+{
+    //the colors of the groups and the orderings inside every group
+    uint32_t groups[3] = {0};
+    uint8_t inner[3][6];
+    int num_inner[3] = {0};
+    for (int g = 0; g < 3; g++)
+    {
+        const uint32_t *c = &colors[g * 3];
+        for (int k = 0; k < 3; k++)
+        {
+            groups[g] += symmetry_mix(c[k], 1);
+        }
+        for (int p = 0; p < 6; p++)
+        {
+            const uint8_t *perm = PERMUTATIONS[p];
+            if (c[perm[0]] <= c[perm[1]] && c[perm[1]] <= c[perm[2]])
+                inner[g][num_inner[g]++] = (uint8_t)p;
+        }
+    }
+
+    int count = 0;
+    for (int p = 0; p < 6; p++)
+    {
+        const uint8_t *outer = PERMUTATIONS[p];
+        if (groups[outer[0]] > groups[outer[1]] || groups[outer[1]] > groups[outer[2]])
+            continue;
+
+        int g0 = outer[0], g1 = outer[1], g2 = outer[2];
+        for (int a = 0; a < num_inner[g0]; a++)
+        {
+            for (int b = 0; b < num_inner[g1]; b++)
+            {
+                for (int c = 0; c < num_inner[g2]; c++)
+                {
+                    const uint8_t *in[3] = {PERMUTATIONS[inner[g0][a]], PERMUTATIONS[inner[g1][b]],
+                                            PERMUTATIONS[inner[g2][c]]};
+                    for (int k = 0; k < 3; k++)
+                    {
+                        for (int m = 0; m < 3; m++)
+                        {
+                            orders[count][k * 3 + m] = (uint8_t)(outer[k] * 3 + in[k][m]);
+                        }
+                    }
+                    count++;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * This function writes the grid in the order of the rows and columns, with
+ * the digits relabeled in the order they appear. It gives up as soon as the
+ * result is bigger than the best one so far and returns false, otherwise it
+ * returns true if the result is smaller
+ */
+static int symmetry_try(const uint8_t *grid, const uint8_t *rows, const uint8_t *cols, const uint8_t *best,
+                        int have_best, uint8_t *result, uint8_t *digits)
+{
+    memset(digits, 0, 10);
+    int next = 1;
+    //whether we are already smaller than the best one
+    int smaller = !have_best;
+
+    for (int i = 0; i < 9; i++)
+    {
+        const uint8_t *row = &grid[rows[i] * 9];
+        for (int j = 0; j < 9; j++)
+        {
+            int d = row[cols[j]];
+            if (d != 0)
+            {
+                if (digits[d] == 0)
+                    digits[d] = (uint8_t)next++;
+                d = digits[d];
+            }
+
+            int index = i * 9 + j;
+            if (!smaller)
+            {
+                if (d > best[index])
+                    return 0;
+                smaller = d < best[index];
+            }
+            result[index] = (uint8_t)d;
+        }
+    }
+    return smaller;
+}
+
+/**
+ * This function finds the canonical form of a sudoku string and how the
+ * sudoku maps to it. The canonical form has the values of the cells, 0 for
+ * the empty ones. Returns false if the sudoku has too many ties to try them
+ * all, then it has no canonical form
+ */
+int symmetry_canonicalize(const char *sudoku, uint8_t *canonical, SudokuTransform *t)
+{
+    //the grid and its transpose
+    uint8_t grids[2][SUDOKU_CELLS];
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        char c = sudoku[i];
+        uint8_t d = (c >= '1' && c <= '9') ? (uint8_t)(c - '0') : 0;
+        grids[0][i] = d;
+        grids[1][CELL_X[i] * 9 + CELL_Y[i]] = d;
+    }
+
+    uint32_t colors[2][9];
+    symmetry_color(grids[0], colors[0], colors[1]);
+
+    //the rows of the transpose are the columns, so they
+    //have the same orderings the other way around
+    uint8_t row_orders[SYMMETRY_MAX_ORDERS][9];
+    uint8_t col_orders[SYMMETRY_MAX_ORDERS][9];
+    int num_rows = symmetry_orders(colors[0], row_orders);
+    int num_cols = symmetry_orders(colors[1], col_orders);
+    if (2 * num_rows * num_cols > SYMMETRY_MAX_CANDIDATES)
+        return 0;
+
+    uint8_t result[SUDOKU_CELLS];
+    uint8_t digits[10];
+    int have_best = 0;
+    for (int transposed = 0; transposed < 2; transposed++)
+    {
+        uint8_t(*lines)[9] = (transposed) ? col_orders : row_orders;
+        uint8_t(*crosses)[9] = (transposed) ? row_orders : col_orders;
+        int num_lines = (transposed) ? num_cols : num_rows;
+        int num_crosses = (transposed) ? num_rows : num_cols;
+
+        for (int r = 0; r < num_lines; r++)
+        {
+            for (int c = 0; c < num_crosses; c++)
+            {
+                if (!symmetry_try(grids[transposed], lines[r], crosses[c], canonical, have_best, result, digits))
+                    continue;
+
+                have_best = 1;
+                memcpy(canonical, result, SUDOKU_CELLS);
+                t->transposed = transposed;
+                memcpy(t->rows, lines[r], 9);
+                memcpy(t->cols, crosses[c], 9);
+                memcpy(t->digits, digits, 10);
+            }
+        }
+    }
+
+    //the digits that are not given take the labels that are left, in order
+    int next = 1;
+    for (int d = 1; d <= 9; d++)
+    {
+        if (t->digits[d] != 0)
+            next++;
+    }
+    for (int d = 1; d <= 9; d++)
+    {
+        if (t->digits[d] == 0)
+            t->digits[d] = (uint8_t)next++;
+        t->inverse[t->digits[d]] = (uint8_t)d;
+    }
+    t->digits[0] = 0;
+    t->inverse[0] = 0;
+
+    return 1;
+}
+
+/**
+ * This function returns the index of the cell of a sudoku that
+ * is cell (i, j) of the canonical form
+ */
+static inline int symmetry_cell(const SudokuTransform *t, int i, int j)
+{
+    int line = t->rows[i];
+    int cross = t->cols[j];
+    return (t->transposed) ? cross * 9 + line : line * 9 + cross;
+}
+
+/**
+ * This function maps the values of a sudoku to the canonical form
+ */
+void symmetry_to_canonical(const SudokuTransform *t, const uint8_t *values, uint8_t *canonical)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        for (int j = 0; j < 9; j++)
+        {
+            canonical[i * 9 + j] = t->digits[values[symmetry_cell(t, i, j)]];
+        }
+    }
+}
+
+/**
+ * This function maps the values of the canonical form back to the sudoku
+ */
+void symmetry_from_canonical(const SudokuTransform *t, const uint8_t *canonical, uint8_t *values)
+{
+    for (int i = 0; i < 9; i++)
+    {
+        for (int j = 0; j < 9; j++)
+        {
+            values[symmetry_cell(t, i, j)] = t->inverse[canonical[i * 9 + j]];
+        }
+    }
+}
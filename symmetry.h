@@ -0,0 +1,30 @@
+#if !defined(SYMMETRY_H)
+#define SYMMETRY_H
+
+#include <stdint.h>
+#include <string.h>
+#include "tables.h"
+
+//how many orderings of the rows and columns we try at most, a sudoku that
+//is left with more ties than that (an almost empty one) is not canonicalized
+#define SYMMETRY_MAX_CANDIDATES 2048
+
+/**
+ * How a sudoku maps to its canonical form. Cell (i, j) of the canonical form
+ * is cell (rows[i], cols[j]) of the sudoku, or of its transpose, with its
+ * digit relabeled by digits. inverse undoes the relabeling
+ */
+typedef struct _SudokuTransform
+{
+    int transposed;
+    uint8_t rows[9];
+    uint8_t cols[9];
+    uint8_t digits[10];
+    uint8_t inverse[10];
+} SudokuTransform;
+
+int symmetry_canonicalize(const char *sudoku, uint8_t *canonical, SudokuTransform *t);
+void symmetry_to_canonical(const SudokuTransform *t, const uint8_t *values, uint8_t *canonical);
+void symmetry_from_canonical(const SudokuTransform *t, const uint8_t *canonical, uint8_t *values);
+
+#endif // SYMMETRY_H
@@ -0,0 +1,49 @@
+#if !defined(TABLES_H)
+#define TABLES_H
+
+#include <stdint.h>
+
+#define SUDOKU_CELLS 81
+#define SUDOKU_NEIGHBORS 20
+
+/**
+ * A set of cells of the sudoku. The grid is split in three bands of three
+ * rows, every band holds 27 cells so it fits in 32 bits. Cell i is bit
+ * (i % 27) of band (i / 27)
+ */
+typedef struct _CellMask
+{
+    uint32_t band[3];
+} CellMask;
+
+#define CELL_MASK_HAS(m, i) (((m).band[(i) / 27] >> ((i) % 27)) & 1)
+#define CELL_MASK_ADD(m, i) ((m).band[(i) / 27] |= (1u << ((i) % 27)))
+#define CELL_MASK_REMOVE(m, i) ((m).band[(i) / 27] &= ~(1u << ((i) % 27)))
+
+extern const uint8_t CELL_X[SUDOKU_CELLS];
+extern const uint8_t CELL_Y[SUDOKU_CELLS];
+extern const uint8_t CELL_BOX[SUDOKU_CELLS];
+
+extern const uint8_t HOUSES[27][9];
+
+//the rows, columns and boxes are consecutive blocks of the houses table
+#define ROWS (HOUSES)
+#define COLUMNS (HOUSES + 9)
+#define BOXES (HOUSES + 18)
+
+#define ROW_HOUSE(y) (y)
+#define COLUMN_HOUSE(x) (9 + (x))
+#define BOX_HOUSE(b) (18 + (b))
+
+extern const uint8_t NEIGHBORS[SUDOKU_CELLS][SUDOKU_NEIGHBORS];
+extern const uint8_t ROW_NEIGHBORS[SUDOKU_CELLS][8];
+extern const uint8_t COL_NEIGHBORS[SUDOKU_CELLS][8];
+extern const uint8_t BOX_NEIGHBORS[SUDOKU_CELLS][8];
+
+extern const CellMask PEER_MASKS[SUDOKU_CELLS];
+extern const CellMask HOUSE_MASKS[27];
+
+int cell_mask_pop(CellMask *m);
+int cell_mask_count(CellMask *m);
+
+#endif // TABLES_H
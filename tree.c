@@ -0,0 +1,349 @@
+#include "tree.h"
+#include "sudoku.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Searching the tree of a single hard sudoku with several threads. The tree
+ * is split at the guesses: a worker that guesses keeps the first child and,
+ * while its deque is short, pushes the others as open subtrees. A worker
+ * whose deque is empty steals the oldest subtree of another worker, which
+ * is the closest to the root, so the workers rarely steal from each other.
+ * A subtree is just the BitboardState of its guess, so it moves between the
+ * workers with a copy. The first solution stops every worker, or when the
+ * solutions are counted, the limit-th one does.
+ */
+
+/**
+ * This function pushes states at the bottom of a deque, moving the ones it
+ * holds to the front when it runs out of room. Returns false if they don't fit
+ */
+static int tree_push(TreeDeque *d, BitboardState *states, int count)
+{
+    int pushed = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom + count > TREE_DEQUE_CAPACITY && d->top > 0)
+    {
+        memmove(d->states, &d->states[d->top], (d->bottom - d->top) * sizeof(BitboardState));
+        d->bottom -= d->top;
+        d->top = 0;
+    }
+    if (d->bottom + count <= TREE_DEQUE_CAPACITY)
+    {
+        memcpy(&d->states[d->bottom], states, count * sizeof(BitboardState));
+        d->bottom += count;
+        pushed = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return pushed;
+}
+
+/**
+ * Takes the newest state from the deque of a worker, returns false if it is empty
+ */
+static int tree_take(TreeDeque *d, BitboardState *s)
+{
+    int taken = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom)
+    {
+        *s = d->states[--d->bottom];
+        taken = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return taken;
+}
+
+/**
+ * Steals the oldest state from the deque of a worker, returns false if it is empty
+ */
+static int tree_steal(TreeDeque *d, BitboardState *s)
+{
+    int taken = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom)
+    {
+        *s = d->states[d->top++];
+        taken = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return taken;
+}
+
+/**
+ * Returns how many states the deque of a worker holds
+ */
+static int tree_size(TreeDeque *d)
+{
+    pthread_mutex_lock(&d->lock);
+    int size = d->bottom - d->top;
+    pthread_mutex_unlock(&d->lock);
+    return size;
+}
+
+/**
+ * This function adds to the subtrees that are not searched yet
+ */
+static inline void tree_add_pending(TreeSearch *t, int count)
+{
+    atomic_fetch_add_explicit(&t->pending, count, memory_order_acq_rel);
+}
+
+/**
+ * This function returns whether the search was stopped
+ */
+static inline int tree_stopped(TreeSearch *t)
+{
+    return atomic_load_explicit(&t->stop, memory_order_relaxed);
+}
+
+/**
+ * This function records a solution, the search
+ * stops once there are as many as we look for
+ */
+static void tree_found(TreeSearch *t, BitboardState *s)
+{
+    pthread_mutex_lock(&t->lock);
+    if (t->solutions < t->limit)
+    {
+        if (t->solutions == 0)
+            bitboard_state_values(s, t->first);
+        t->solutions++;
+        if (t->solutions == t->limit)
+            atomic_store_explicit(&t->stop, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&t->lock);
+}
+
+/**
+ * This function searches a subtree depth first. The other children of a
+ * guess are shared while the deque of the worker is short and searched
+ * here otherwise, or when they don't fit in it
+ */
+static void tree_search_node(TreeSearch *t, TreeWorker *w, BitboardState *s)
+{
+    if (t->cancel != NULL && atomic_load_explicit(t->cancel, memory_order_relaxed))
+        atomic_store_explicit(&t->stop, 1, memory_order_relaxed);
+    if (tree_stopped(t))
+        return;
+
+    BitboardState children[BITBOARD_DIGITS];
+    int count = bitboard_expand(&w->board, s, children);
+    if (count < 0)
+        return;
+    if (count == 0)
+    {
+        tree_found(t, s);
+        return;
+    }
+
+    //the subtrees are counted before they are pushed, so
+    //that the count can't reach 0 while they are in the deque
+    int local = count;
+    TreeDeque *d = &t->deques[w->id];
+    if (count > 1 && t->num_threads > 1 && tree_size(d) < TREE_SHARE_BELOW)
+    {
+        tree_add_pending(t, count - 1);
+        if (tree_push(d, &children[1], count - 1))
+            local = 1;
+        else
+            tree_add_pending(t, 1 - count);
+    }
+
+    for (int k = 0; k < local; k++)
+    {
+        tree_search_node(t, w, &children[k]);
+    }
+}
+
+/**
+ * This function searches subtrees until none are left or the search stops,
+ * a worker takes its own newest subtree first and otherwise steals one
+ */
+static void tree_work(TreeSearch *t, TreeWorker *w)
+{
+    BitboardState s;
+    while (!tree_stopped(t) && atomic_load_explicit(&t->pending, memory_order_acquire) > 0)
+    {
+        int taken = tree_take(&t->deques[w->id], &s);
+        for (int k = 1; k < t->num_threads && !taken; k++)
+        {
+            taken = tree_steal(&t->deques[(w->id + k) % t->num_threads], &s);
+        }
+
+        if (!taken)
+        {
+            sched_yield();
+            continue;
+        }
+        tree_search_node(t, w, &s);
+        tree_add_pending(t, -1);
+    }
+}
+
+/**
+ * The thread of a worker, it searches every sudoku until the search is freed
+ */
+static void *tree_thread(void *arg)
+{
+    TreeWorker *w = (TreeWorker *)arg;
+    TreeSearch *t = w->search;
+    int seen = 0;
+
+    while (1)
+    {
+        pthread_mutex_lock(&t->lock);
+        while (t->generation == seen && !t->quit)
+        {
+            pthread_cond_wait(&t->start, &t->lock);
+        }
+        int quit = t->quit;
+        seen = t->generation;
+        pthread_mutex_unlock(&t->lock);
+
+        if (quit)
+            break;
+        tree_work(t, w);
+
+        pthread_mutex_lock(&t->lock);
+        t->finished++;
+        pthread_cond_signal(&t->done);
+        pthread_mutex_unlock(&t->lock);
+    }
+    return NULL;
+}
+
+/**
+ * This function creates a team of threads that search together, the search
+ * gives up when the cancel flag is set, it can be NULL
+ */
+TreeSearch *create_tree_search(int num_threads, atomic_int *cancel)
+{
+    TreeSearch *t = (TreeSearch *)malloc(sizeof(TreeSearch));
+    t->num_threads = (num_threads < 1) ? 1 : (num_threads > TREE_MAX_THREADS) ? TREE_MAX_THREADS : num_threads;
+    t->deques = (TreeDeque *)aligned_alloc(POOL_CACHE_LINE, t->num_threads * sizeof(TreeDeque));
+    t->workers = (TreeWorker *)aligned_alloc(POOL_CACHE_LINE, t->num_threads * sizeof(TreeWorker));
+    t->threads = (pthread_t *)malloc(t->num_threads * sizeof(pthread_t));
+    t->generation = 0;
+    t->finished = 0;
+    t->quit = 0;
+    atomic_init(&t->pending, 0);
+    atomic_init(&t->stop, 0);
+    t->cancel = cancel;
+    t->solutions = 0;
+    t->limit = 0;
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->start, NULL);
+    pthread_cond_init(&t->done, NULL);
+
+    for (int k = 0; k < t->num_threads; k++)
+    {
+        pthread_mutex_init(&t->deques[k].lock, NULL);
+        t->deques[k].top = 0;
+        t->deques[k].bottom = 0;
+        t->workers[k].search = t;
+        t->workers[k].id = k;
+        t->workers[k].board.cancel = NULL;
+    }
+
+    //the caller searches as the first worker
+    for (int k = 1; k < t->num_threads; k++)
+    {
+        pthread_create(&t->threads[k], NULL, tree_thread, &t->workers[k]);
+    }
+    return t;
+}
+
+/**
+ * This function stops the threads of the workers and frees the search
+ */
+void tree_search_free(TreeSearch *t)
+{
+    pthread_mutex_lock(&t->lock);
+    t->quit = 1;
+    pthread_cond_broadcast(&t->start);
+    pthread_mutex_unlock(&t->lock);
+
+    for (int k = 1; k < t->num_threads; k++)
+    {
+        pthread_join(t->threads[k], NULL);
+    }
+    for (int k = 0; k < t->num_threads; k++)
+    {
+        pthread_mutex_destroy(&t->deques[k].lock);
+    }
+    pthread_mutex_destroy(&t->lock);
+    pthread_cond_destroy(&t->start);
+    pthread_cond_destroy(&t->done);
+    free(t->threads);
+    free(t->workers);
+    free(t->deques);
+    free(t);
+}
+
+/**
+ * This function counts the solutions of the sudoku loaded in a bitboard up
+ * until there are limit of them, like bitboard_count_solutions but with every
+ * worker. The values of the bitboard become the first solution that was
+ * found, which is not always the first one in the order of the search. The
+ * steps are the guesses of all the workers
+ */
+void tree_search_count(TreeSearch *t, Bitboard *b, int limit, int *result, int *count, int *steps)
+{
+    b->steps = 0;
+    b->solutions = 0;
+    b->limit = limit;
+
+    //the subtrees of the last sudoku that were left when it stopped are dropped
+    for (int k = 0; k < t->num_threads; k++)
+    {
+        memcpy(t->workers[k].board.values, b->values, SUDOKU_CELLS);
+        t->workers[k].board.steps = 0;
+        t->deques[k].top = 0;
+        t->deques[k].bottom = 0;
+    }
+
+    //a given that doesn't fit makes the sudoku unsolvable
+    BitboardState s;
+    if (bitboard_start(b, &s))
+    {
+        t->deques[0].states[0] = s;
+        t->deques[0].bottom = 1;
+
+        pthread_mutex_lock(&t->lock);
+        atomic_store_explicit(&t->pending, 1, memory_order_relaxed);
+        atomic_store_explicit(&t->stop, 0, memory_order_relaxed);
+        t->solutions = 0;
+        t->limit = limit;
+        t->finished = 0;
+        t->generation++;
+        pthread_cond_broadcast(&t->start);
+        pthread_mutex_unlock(&t->lock);
+
+        tree_work(t, &t->workers[0]);
+
+        pthread_mutex_lock(&t->lock);
+        while (t->finished < t->num_threads - 1)
+        {
+            pthread_cond_wait(&t->done, &t->lock);
+        }
+        pthread_mutex_unlock(&t->lock);
+
+        b->solutions = t->solutions;
+        for (int k = 0; k < t->num_threads; k++)
+        {
+            b->steps += t->workers[k].board.steps;
+        }
+    }
+
+    if (b->solutions > 0)
+        memcpy(b->values, t->first, SUDOKU_CELLS);
+
+    *result = (b->solutions > 0) ? SUDOKU_SOLVED : SUDOKU_NO_SOLUTUION;
+    //the count of a search that was stopped is not complete
+    if (t->cancel != NULL && atomic_load_explicit(t->cancel, memory_order_relaxed) && b->solutions < limit)
+        *result = SUDOKU_UNDECIDED;
+    *count = b->solutions;
+    *steps = b->steps;
+}
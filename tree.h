@@ -0,0 +1,83 @@
+#if !defined(TREE_H)
+#define TREE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "bitboard.h"
+#include "pool.h"
+
+//how many threads can search the same sudoku
+#define TREE_MAX_THREADS 64
+//how many open subtrees a deque holds
+#define TREE_DEQUE_CAPACITY 64
+//a worker shares the other children of a guess while its deque
+//holds fewer subtrees than this, otherwise it searches them itself
+#define TREE_SHARE_BELOW 4
+
+/**
+ * The open subtrees of a worker, they are the states in [top, bottom). The
+ * owner pushes and pops the newest ones at the bottom, the others steal the
+ * oldest ones at the top, which are the closest to the root and so the biggest
+ */
+typedef struct _TreeDeque
+{
+    pthread_mutex_t lock;
+    int top;
+    int bottom;
+    BitboardState states[TREE_DEQUE_CAPACITY];
+} __attribute__((aligned(POOL_CACHE_LINE))) TreeDeque;
+
+struct _TreeSearch;
+
+/**
+ * What the thread of a worker needs to know, with the bitboard it searches
+ * with, the steps it counts are its own
+ */
+typedef struct _TreeWorker
+{
+    struct _TreeSearch *search;
+    int id;
+    Bitboard board;
+} __attribute__((aligned(POOL_CACHE_LINE))) TreeWorker;
+
+/**
+ * A team of threads that search the tree of a single sudoku together. The
+ * caller searches as the first worker, the others have a thread each that
+ * waits for the next sudoku. The search stops when every subtree is searched
+ * or when enough solutions are found
+ */
+typedef struct _TreeSearch
+{
+    int num_threads;
+    TreeDeque *deques;
+    TreeWorker *workers;
+    pthread_t *threads;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    //counts the sudokus, a worker starts when it sees a new one
+    int generation;
+    int finished;
+    int quit;
+
+    //the subtrees that are in a deque or being searched, the workers read
+    //and change it without the lock and the search is over when it is 0
+    atomic_int pending;
+    //set when enough solutions are found, or when the caller's flag is set
+    atomic_int stop;
+    atomic_int *cancel;
+
+    //the solutions found so far, how many we look for and the first one,
+    //they are changed under the lock
+    int solutions;
+    int limit;
+    uint8_t first[SUDOKU_CELLS];
+} TreeSearch;
+
+TreeSearch *create_tree_search(int num_threads, atomic_int *cancel);
+void tree_search_free(TreeSearch *t);
+void tree_search_count(TreeSearch *t, Bitboard *b, int limit, int *result, int *count, int *steps);
+
+#endif // TREE_H
@@ -25,43 +25,15 @@ void array_print(int *a, int size)
 }
 
 /**
- * This function returns the system time in seconds
+ * This function returns the time in nanoseconds that has passed since some
+ * fixed point in the past. The clock is monotonic, so the difference of two
+ * calls is never negative, not even when the system time is changed
  */
-float getTime()
+int64_t getTimeNs()
 {
-    return (float)clock() / CLOCKS_PER_SEC;
-}
-
-/**
- * This function creates an array of sudoku strigns from a file
- */
-char **create_sudoku_string_array_from_file(char *filename, int num_sudokus)
-{
-
-    //allocate space for the sudoku strings
-    char **sud_str_array = (char **)malloc(num_sudokus * sizeof(char *));
-    for (int i = 0; i < num_sudokus; i++)
-    {
-        //allocate memory for every sudoku string
-        sud_str_array[i] = (char *)malloc(90 * sizeof(char));
-        memset(sud_str_array[i], 0, 90);
-    }
-
-    return get_sudokus_from_file(filename, sud_str_array, num_sudokus);
-}
-
-/**
- * This function frees the sudoku string arrat from memory
- */
-void sudoku_free_string_array(char **array, int size)
-{
-    //free every string
-    for (int i = 0; i < size; i++)
-    {
-        free(array[i]);
-    }
-    //and then free the array itself
-    free(array);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
 /**
@@ -85,7 +57,20 @@ int compare_int(const void *a, const void *b)
  */
 int compare_float(const void *a, const void *b)
 {
-    return (*(float *)a - *(float *)b);
+    float x = *(float *)a;
+    float y = *(float *)b;
+    //the difference would be truncated to an int, so compare instead
+    return (x > y) - (x < y);
+}
+
+/**
+ * Order function for sorting an int64_t array
+ */
+int compare_int64(const void *a, const void *b)
+{
+    int64_t x = *(int64_t *)a;
+    int64_t y = *(int64_t *)b;
+    return (x > y) - (x < y);
 }
 
 float floor_n(float n)
@@ -93,6 +78,23 @@ float floor_n(float n)
     return (float)((int)n);
 }
 
+/**
+ * This function converts a duration in nanoseconds to a short string
+ * in the most readable unit, 1234 becomes 1.234us
+ */
+char *format_duration_ns(int64_t ns, char *buff, int buff_size)
+{
+    if (ns < 1000)
+        snprintf(buff, buff_size, "%ldns", (long)ns);
+    else if (ns < 1000000)
+        snprintf(buff, buff_size, "%.3fus", ns / 1e3);
+    else if (ns < 1000000000)
+        snprintf(buff, buff_size, "%.3fms", ns / 1e6);
+    else
+        snprintf(buff, buff_size, "%.3fs", ns / 1e9);
+    return buff;
+}
+
 /**
  * This function receives a time value in seconds and converts it to
  * human readable string
@@ -2,6 +2,7 @@
 #define UTILS_SUD
 
 #include <stdio.h>
+#include <stdint.h>
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
@@ -16,12 +17,12 @@
 #define floor_float(a) (float)((int)a)
 
 void array_print(int *a, int size);
-float getTime();
-char **create_sudoku_string_array_from_file(char *filename, int num_sudokus);
-void sudoku_free_string_array(char **array, int size);
+int64_t getTimeNs();
 int strequals(char *s1, char *s2);
 int compare_int(const void *a, const void *b);
 int compare_float(const void *a, const void *b);
+int compare_int64(const void *a, const void *b);
+char *format_duration_ns(int64_t ns, char *buff, int buff_size);
 char *format_time_seconds(float timeSeconds, char *buff, int buff_size);
 int get_bit(int value, int position);
 int set_bit(int *value, int position, short new_bit_value);
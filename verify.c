@@ -0,0 +1,109 @@
+#include "verify.h"
+
+/**
+ * Checks for completed grids. They run after every solve, so they avoid
+ * branches over the cells and work on 16 cells at once with the vector
+ * extensions of the compiler, the same way batch.c does. Every value becomes
+ * a bit of a mask, a house is valid when the masks of its cells cover exactly
+ * the values 1 to 9, since a house has 9 cells that also means that no value
+ * appears twice.
+ */
+
+//the mask of a house that has every value from 1 to 9
+#define VERIFY_ALL_VALUES 0x3fe
+
+//16 cells of a grid, as bytes or as the bits of their values
+typedef uint8_t VerifyBytes __attribute__((vector_size(16)));
+typedef uint16_t VerifyBits __attribute__((vector_size(32)));
+
+//the bit of every value, 0 for the values that are not from 1 to 9
+static const uint16_t VALUE_BITS[256] = {0, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7, 1 << 8, 1 << 9};
+
+/**
+ * This function returns true if a digit of a sudoku string was changed in the
+ * values. The cells are compared 16 at a time, the last block overlaps with
+ * the one before it so that it doesn't read past the end of the grid
+ */
+static int verify_givens_changed(const uint8_t *values, const char *givens)
+{
+    VerifyBytes changed = {0};
+    for (int i = 0; i < SUDOKU_CELLS; i += 16)
+    {
+        int at = (i + 16 <= SUDOKU_CELLS) ? i : SUDOKU_CELLS - 16;
+
+        VerifyBytes given, value;
+        memcpy(&given, givens + at, sizeof(given));
+        memcpy(&value, values + at, sizeof(value));
+
+        //the chars that are not digits from 1 to 9 are empty cells
+        given -= '0';
+        changed |= (VerifyBytes)((given - 1 < 9) & (given != value));
+    }
+
+    uint64_t halves[2];
+    memcpy(halves, &changed, sizeof(halves));
+    return (halves[0] | halves[1]) != 0;
+}
+
+/**
+ * This function checks that a grid is a valid solution of a sudoku: every cell
+ * has a value from 1 to 9, every row, column and box has every value once and
+ * every given of the sudoku string is kept. Returns one of the VERIFY_* codes
+ */
+int verify_solution(const uint8_t *values, const char *givens)
+{
+    //the bit of the value of every cell, padded so that
+    //every row can be read as a block of 16 cells
+    uint16_t bits[SUDOKU_CELLS + 16];
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        bits[i] = VALUE_BITS[values[i]];
+    }
+    memset(&bits[SUDOKU_CELLS], 0, 16 * sizeof(uint16_t));
+
+    //the union of the bits of every row, column and box,
+    //only the first 9 lanes of the columns are used
+    uint16_t rows[9];
+    uint16_t boxes[9] = {0};
+    VerifyBits cols = {0};
+    for (int y = 0; y < 9; y++)
+    {
+        VerifyBits row;
+        memcpy(&row, &bits[y * 9], sizeof(row));
+        cols |= row;
+
+        uint16_t left = row[0] | row[1] | row[2];
+        uint16_t middle = row[3] | row[4] | row[5];
+        uint16_t right = row[6] | row[7] | row[8];
+        rows[y] = left | middle | right;
+
+        uint16_t *band = &boxes[(y / 3) * 3];
+        band[0] |= left;
+        band[1] |= middle;
+        band[2] |= right;
+    }
+
+    int invalid = 0;
+    for (int h = 0; h < 9; h++)
+    {
+        invalid |= (rows[h] & cols[h] & boxes[h]) != VERIFY_ALL_VALUES;
+    }
+    if (invalid)
+        return VERIFY_INVALID_HOUSE;
+
+    return (verify_givens_changed(values, givens)) ? VERIFY_GIVENS_CHANGED : VERIFY_OK;
+}
+
+/**
+ * This function returns true if a grid is the same as the expected
+ * solution, a string of SUDOKU_CELLS digits
+ */
+int verify_matches(const uint8_t *values, const char *expected)
+{
+    int differ = 0;
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        differ |= expected[i] - '0' != values[i];
+    }
+    return !differ;
+}
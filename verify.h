@@ -0,0 +1,18 @@
+#if !defined(VERIFY_H)
+#define VERIFY_H
+
+#include <stdint.h>
+#include <string.h>
+#include "tables.h"
+
+//the results of verifying a solution
+#define VERIFY_OK 0
+//a row, column or box doesn't have every value exactly once
+#define VERIFY_INVALID_HOUSE 1
+//a given of the sudoku was changed
+#define VERIFY_GIVENS_CHANGED 2
+
+int verify_solution(const uint8_t *values, const char *givens);
+int verify_matches(const uint8_t *values, const char *expected);
+
+#endif // VERIFY_H